@@ -643,6 +643,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/c_include_iterator.cc',
         'src/gn/c_substitution_type.cc',
         'src/gn/c_tool.cc',
+        'src/gn/chunk_renderer.cc',
         'src/gn/command_analyze.cc',
         'src/gn/command_args.cc',
         'src/gn/command_check.cc',
@@ -673,6 +674,8 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/escape.cc',
         'src/gn/exec_process.cc',
         'src/gn/filesystem_utils.cc',
+        'src/gn/flag_block_cache.cc',
+        'src/gn/file_write_queue.cc',
         'src/gn/file_writer.cc',
         'src/gn/frameworks_utils.cc',
         'src/gn/function_exec_script.cc',
@@ -707,6 +710,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/json_project_writer.cc',
         'src/gn/label.cc',
         'src/gn/label_pattern.cc',
+        'src/gn/label_pattern_matcher.cc',
         'src/gn/lib_file.cc',
         'src/gn/loader.cc',
         'src/gn/location.cc',
@@ -732,6 +736,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/operators.cc',
         'src/gn/output_conversion.cc',
         'src/gn/output_file.cc',
+        'src/gn/output_manifest.cc',
         'src/gn/parse_node_value_adapter.cc',
         'src/gn/parse_tree.cc',
         'src/gn/parser.cc',
@@ -804,6 +809,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/builder_unittest.cc',
         'src/gn/bundle_data_unittest.cc',
         'src/gn/c_include_iterator_unittest.cc',
+        'src/gn/chunk_renderer_unittest.cc',
         'src/gn/command_format_unittest.cc',
         'src/gn/commands_unittest.cc',
         'src/gn/compile_commands_writer_unittest.cc',
@@ -812,6 +818,8 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/escape_unittest.cc',
         'src/gn/exec_process_unittest.cc',
         'src/gn/filesystem_utils_unittest.cc',
+        'src/gn/flag_block_cache_unittest.cc',
+        'src/gn/file_write_queue_unittest.cc',
         'src/gn/file_writer_unittest.cc',
         'src/gn/frameworks_utils_unittest.cc',
         'src/gn/function_filter_unittest.cc',
@@ -837,6 +845,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/rust_project_writer_unittest.cc',
         'src/gn/rust_project_writer_helpers_unittest.cc',
         'src/gn/label_pattern_unittest.cc',
+        'src/gn/label_pattern_matcher_unittest.cc',
         'src/gn/label_unittest.cc',
         'src/gn/loader_unittest.cc',
         'src/gn/metadata_unittest.cc',
@@ -857,6 +866,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/ninja_toolchain_writer_unittest.cc',
         'src/gn/operators_unittest.cc',
         'src/gn/output_conversion_unittest.cc',
+        'src/gn/output_manifest_unittest.cc',
         'src/gn/parse_tree_unittest.cc',
         'src/gn/parser_unittest.cc',
         'src/gn/path_output_unittest.cc',
@@ -0,0 +1,149 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_HASH_H_
+#define BASE_HASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <string_view>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace base {
+
+// Fast non-cryptographic hashing of byte strings, for hash tables and content
+// fingerprints. Do not use it where an adversary controls the input and
+// collisions matter, use SHA-1 then.
+//
+// The algorithm is wyhash (final version 4) by Wang Yi, which is released
+// into the public domain. Bytes are read in native byte order, so the values
+// are stable across runs and builds on the same platform, but may differ
+// between little- and big-endian platforms.
+
+namespace internal {
+
+inline void WyMultiply(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = *a;
+  r *= *b;
+  *a = static_cast<uint64_t>(r);
+  *b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  *a = _umul128(*a, *b, b);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32;
+  uint64_t la = static_cast<uint32_t>(*a), lb = static_cast<uint32_t>(*b);
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  *a = lo;
+  *b = hi;
+#endif
+}
+
+inline uint64_t WyMix(uint64_t a, uint64_t b) {
+  WyMultiply(&a, &b);
+  return a ^ b;
+}
+
+inline uint64_t WyRead8(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t WyRead4(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Reads 1 to 3 bytes.
+inline uint64_t WyRead3(const uint8_t* p, size_t k) {
+  return (static_cast<uint64_t>(p[0]) << 16) |
+         (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+constexpr uint64_t kWySecret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull,
+    0x4d5a2da51de1aa47ull};
+
+}  // namespace internal
+
+// Returns the 64-bit hash of the |length| bytes at |data|.
+inline uint64_t FastHash64(const void* data, size_t length, uint64_t seed = 0) {
+  using internal::WyMix;
+  using internal::WyRead4;
+  using internal::WyRead8;
+  const uint64_t* secret = internal::kWySecret;
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  seed ^= WyMix(seed ^ secret[0], secret[1]);
+  uint64_t a, b;
+  if (length <= 16) {
+    if (length >= 4) {
+      size_t offset = (length >> 3) << 2;
+      a = (WyRead4(p) << 32) | WyRead4(p + offset);
+      b = (WyRead4(p + length - 4) << 32) | WyRead4(p + length - 4 - offset);
+    } else if (length > 0) {
+      a = internal::WyRead3(p, length);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = length;
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = WyMix(WyRead8(p) ^ secret[1], WyRead8(p + 8) ^ seed);
+        see1 = WyMix(WyRead8(p + 16) ^ secret[2], WyRead8(p + 24) ^ see1);
+        see2 = WyMix(WyRead8(p + 32) ^ secret[3], WyRead8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = WyMix(WyRead8(p) ^ secret[1], WyRead8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    // Reads the last 16 bytes, which may overlap with the ones hashed above.
+    a = WyRead8(p + i - 16);
+    b = WyRead8(p + i - 8);
+  }
+  a ^= secret[1];
+  b ^= seed;
+  internal::WyMultiply(&a, &b);
+  return WyMix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+inline uint64_t FastHash64(std::string_view str) {
+  return FastHash64(str.data(), str.size());
+}
+
+// Returns a hash of |str| suitable for hash tables.
+inline size_t FastHash(std::string_view str) {
+  return static_cast<size_t>(FastHash64(str));
+}
+
+// Hash functor for string-keyed standard containers, e.g.
+// std::unordered_map<std::string, Foo, base::StringHash>.
+struct StringHash {
+  size_t operator()(std::string_view str) const { return FastHash(str); }
+  size_t operator()(const std::string& str) const { return FastHash(str); }
+};
+
+}  // namespace base
+
+#endif  // BASE_HASH_H_
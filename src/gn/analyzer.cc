@@ -6,8 +6,12 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
+#include <optional>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "base/json/json_reader.h"
@@ -117,20 +121,10 @@ Label AbsoluteOrSourceAbsoluteStringToLabel(const Label& default_toolchain,
 }
 
 Err JSONToInputs(const Label& default_toolchain,
-                 const std::string input,
+                 const base::Value& value,
                  Inputs* inputs) {
-  int error_code_out;
-  std::string error_msg_out;
-  int error_line_out;
-  int error_column_out;
-  std::unique_ptr<base::Value> value = base::JSONReader::ReadAndReturnError(
-      input, base::JSONParserOptions::JSON_PARSE_RFC, &error_code_out,
-      &error_msg_out, &error_line_out, &error_column_out);
-  if (!value)
-    return Err(Location(), "Input is not valid JSON:" + error_msg_out);
-
   const base::DictionaryValue* dict;
-  if (!value->GetAsDictionary(&dict))
+  if (!value.GetAsDictionary(&dict))
     return Err(Location(), "Input is not a dictionary.");
 
   Err err;
@@ -200,10 +194,9 @@ Err JSONToInputs(const Label& default_toolchain,
   return Err();
 }
 
-std::string OutputsToJSON(const Outputs& outputs,
-                          const Label& default_toolchain,
-                          Err* err) {
-  std::string output;
+std::unique_ptr<base::DictionaryValue> OutputsToValue(
+    const Outputs& outputs,
+    const Label& default_toolchain) {
   auto value = std::make_unique<base::DictionaryValue>();
 
   if (outputs.error.size()) {
@@ -223,12 +216,45 @@ std::string OutputsToJSON(const Outputs& outputs,
     }
     WriteLabels(default_toolchain, *value, "test_targets", outputs.test_labels);
   }
+  return value;
+}
 
-  if (!base::JSONWriter::Write(*value.get(), &output))
+std::string ValueToJSON(const base::Value& value, Err* err) {
+  std::string output;
+  if (!base::JSONWriter::Write(value, &output))
     *err = Err(Location(), "Failed to marshal JSON value for output");
   return output;
 }
 
+// Calls |callback| with every item that |item| depends on.
+template <typename Callback>
+void ForEachItemDependency(const Item* item, Callback callback) {
+  if (const Target* target = item->AsTarget()) {
+    for (const auto& dep_target_pair : target->GetDeps(Target::DEPS_ALL))
+      callback(dep_target_pair.ptr);
+
+    for (const auto& dep_config_pair : target->configs())
+      callback(dep_config_pair.ptr);
+
+    callback(target->toolchain());
+
+    if (target->IsBinary() || target->output_type() == Target::ACTION ||
+        target->output_type() == Target::ACTION_FOREACH) {
+      const LabelPtrPair<Pool>& pool = target->pool();
+      if (pool.ptr)
+        callback(pool.ptr);
+    }
+  } else if (const Config* config = item->AsConfig()) {
+    for (const auto& dep_config_pair : config->configs())
+      callback(dep_config_pair.ptr);
+  } else if (const Toolchain* toolchain = item->AsToolchain()) {
+    for (const auto& dep_pair : toolchain->deps())
+      callback(dep_pair.ptr);
+  } else {
+    DCHECK(item->AsPool());
+  }
+}
+
 }  // namespace
 
 Analyzer::Analyzer(const Builder& builder,
@@ -240,49 +266,107 @@ Analyzer::Analyzer(const Builder& builder,
       build_config_file_(build_config_file),
       dot_file_(dot_file),
       build_args_dependency_files_(build_args_dependency_files) {
-  for (const auto* item : all_items_) {
+  // Maps the resolved index of items to their position in all_items_. Items
+  // are only defined but not resolved when the build has errors, and have
+  // no index; their dependencies are not resolved either.
+  constexpr size_t kNotInAllItems = std::numeric_limits<size_t>::max();
+  std::vector<size_t> item_positions(builder.resolved_item_count(),
+                                     kNotInAllItems);
+  std::unordered_map<const Item*, size_t> unresolved_item_positions;
+  for (size_t i = 0; i < all_items_.size(); i++) {
+    const Item* item = all_items_[i];
     labels_to_items_[item->label()] = item;
+    if (item->resolved_index() != Item::kNoResolvedIndex)
+      item_positions[item->resolved_index()] = i;
+    else
+      unresolved_item_positions[item] = i;
+  }
+  auto position_of = [&](const Item* item) {
+    if (!item)
+      return kNotInAllItems;
+    size_t index = item->resolved_index();
+    if (index != Item::kNoResolvedIndex)
+      return item_positions[index];
+    auto found = unresolved_item_positions.find(item);
+    return found != unresolved_item_positions.end() ? found->second
+                                                    : kNotInAllItems;
+  };
+
+  // Build the reverse dependency graph in two passes: count the dependents
+  // of each item, then fill them in.
+  dependents_begin_.assign(all_items_.size() + 1, 0);
+  for (const Item* item : all_items_) {
+    ForEachItemDependency(item, [&](const Item* dep) {
+      size_t position = position_of(dep);
+      if (position != kNotInAllItems)
+        dependents_begin_[position + 1]++;
+    });
+  }
+  for (size_t i = 0; i < all_items_.size(); i++)
+    dependents_begin_[i + 1] += dependents_begin_[i];
+
+  dependents_.resize(dependents_begin_.back());
+  std::vector<size_t> next_dependent(dependents_begin_.begin(),
+                                     dependents_begin_.end() - 1);
+  for (size_t i = 0; i < all_items_.size(); i++) {
+    ForEachItemDependency(all_items_[i], [&](const Item* dep) {
+      size_t position = position_of(dep);
+      if (position != kNotInAllItems)
+        dependents_[next_dependent[position]++] = i;
+    });
+  }
 
-    // Fill dep_map_.
-    if (item->AsTarget()) {
-      for (const auto& dep_target_pair :
-           item->AsTarget()->GetDeps(Target::DEPS_ALL))
-        dep_map_.insert(std::make_pair(dep_target_pair.ptr, item));
+  for (size_t i = 0; i < all_items_.size(); i++)
+    AddFilesReferredToByItem(i);
+}
 
-      for (const auto& dep_config_pair : item->AsTarget()->configs())
-        dep_map_.insert(std::make_pair(dep_config_pair.ptr, item));
+Analyzer::~Analyzer() = default;
 
-      dep_map_.insert(std::make_pair(item->AsTarget()->toolchain(), item));
+// Results that can be shared by the queries of one Analyze() call.
+struct Analyzer::QueryCache {
+  // The affected items for each set of modified files, keyed by the sorted
+  // file names. Batched queries usually differ only by their targets.
+  std::map<std::vector<std::string>, std::vector<bool>> affected_items;
 
-      if (item->AsTarget()->IsBinary() ||
-          item->AsTarget()->output_type() == Target::ACTION ||
-          item->AsTarget()->output_type() == Target::ACTION_FOREACH) {
-        const LabelPtrPair<Pool>& pool = item->AsTarget()->pool();
-        if (pool.ptr)
-          dep_map_.insert(std::make_pair(pool.ptr, item));
-      }
-    } else if (item->AsConfig()) {
-      for (const auto& dep_config_pair : item->AsConfig()->configs())
-        dep_map_.insert(std::make_pair(dep_config_pair.ptr, item));
-    } else if (item->AsToolchain()) {
-      for (const auto& dep_pair : item->AsToolchain()->deps())
-        dep_map_.insert(std::make_pair(dep_pair.ptr, item));
-    } else {
-      DCHECK(item->AsPool());
-    }
+  // Computed on first use.
+  std::optional<TargetSet> root_targets;
+};
+
+std::string Analyzer::Analyze(const std::string& input, Err* err) const {
+  int error_code_out;
+  std::string error_msg_out;
+  int error_line_out;
+  int error_column_out;
+  std::unique_ptr<base::Value> value = base::JSONReader::ReadAndReturnError(
+      input, base::JSONParserOptions::JSON_PARSE_RFC, &error_code_out,
+      &error_msg_out, &error_line_out, &error_column_out);
+  if (!value) {
+    Outputs outputs;
+    outputs.error = "Input is not valid JSON:" + error_msg_out;
+    return ValueToJSON(*OutputsToValue(outputs, default_toolchain_), err);
   }
-}
 
-Analyzer::~Analyzer() = default;
+  QueryCache cache;
+  if (!value->is_list())
+    return ValueToJSON(*AnalyzeQuery(*value, &cache), err);
 
-std::string Analyzer::Analyze(const std::string& input, Err* err) const {
+  // Batch mode: answer each query of the list in order.
+  base::ListValue results;
+  for (const base::Value& query : value->GetList())
+    results.Append(AnalyzeQuery(query, &cache));
+  return ValueToJSON(results, err);
+}
+
+std::unique_ptr<base::DictionaryValue> Analyzer::AnalyzeQuery(
+    const base::Value& input,
+    QueryCache* cache) const {
   Inputs inputs;
   Outputs outputs;
 
   Err local_err = JSONToInputs(default_toolchain_, input, &inputs);
   if (local_err.has_error()) {
     outputs.error = local_err.message();
-    return OutputsToJSON(outputs, default_toolchain_, err);
+    return OutputsToValue(outputs, default_toolchain_);
   }
 
   std::set<Label> invalid_labels;
@@ -293,7 +377,7 @@ std::string Analyzer::Analyze(const std::string& input, Err* err) const {
   if (!invalid_labels.empty()) {
     outputs.error = "Invalid targets";
     outputs.invalid_labels = invalid_labels;
-    return OutputsToJSON(outputs, default_toolchain_, err);
+    return OutputsToValue(outputs, default_toolchain_);
   }
 
   if (WereMainGNFilesModified(inputs.source_files)) {
@@ -307,31 +391,44 @@ std::string Analyzer::Analyze(const std::string& input, Err* err) const {
                                     inputs.test_labels.end());
     }
     outputs.test_labels = inputs.test_labels;
-    return OutputsToJSON(outputs, default_toolchain_, err);
+    return OutputsToValue(outputs, default_toolchain_);
   }
 
-  std::set<const Item*> affected_items =
-      GetAllAffectedItems(inputs.source_files);
+  std::vector<std::string> file_names;
+  for (const SourceFile* file : inputs.source_files)
+    file_names.push_back(file->value());
+  std::sort(file_names.begin(), file_names.end());
+  auto cached_affected_items = cache->affected_items.find(file_names);
+  if (cached_affected_items == cache->affected_items.end()) {
+    cached_affected_items =
+        cache->affected_items
+            .emplace(std::move(file_names),
+                     GetAllAffectedItems(inputs.source_files))
+            .first;
+  }
+  const std::vector<bool>& affected_items = cached_affected_items->second;
   TargetSet affected_targets;
-  for (const Item* affected_item : affected_items) {
-    if (affected_item->AsTarget())
-      affected_targets.insert(affected_item->AsTarget());
+  for (size_t i = 0; i < all_items_.size(); i++) {
+    if (affected_items[i] && all_items_[i]->AsTarget())
+      affected_targets.insert(all_items_[i]->AsTarget());
   }
 
   if (affected_targets.empty()) {
     outputs.status = "No dependency";
-    return OutputsToJSON(outputs, default_toolchain_, err);
-  }
-
-  TargetSet root_targets;
-  for (const auto* item : all_items_) {
-    if (item->AsTarget() && dep_map_.find(item) == dep_map_.end())
-      root_targets.insert(item->AsTarget());
+    return OutputsToValue(outputs, default_toolchain_);
   }
 
   TargetSet compile_targets = TargetsFor(inputs.compile_labels);
   if (inputs.compile_included_all) {
-    for (auto* root_target : root_targets)
+    if (!cache->root_targets) {
+      TargetSet& root_targets = cache->root_targets.emplace();
+      for (size_t i = 0; i < all_items_.size(); i++) {
+        if (all_items_[i]->AsTarget() &&
+            dependents_begin_[i] == dependents_begin_[i + 1])
+          root_targets.insert(all_items_[i]->AsTarget());
+      }
+    }
+    for (auto* root_target : *cache->root_targets)
       compile_targets.insert(root_target);
   }
   TargetSet filtered_targets = Filter(compile_targets);
@@ -351,20 +448,42 @@ std::string Analyzer::Analyze(const std::string& input, Err* err) const {
     outputs.status = "No dependency";
   else
     outputs.status = "Found dependency";
-  return OutputsToJSON(outputs, default_toolchain_, err);
+  return OutputsToValue(outputs, default_toolchain_);
 }
 
-std::set<const Item*> Analyzer::GetAllAffectedItems(
+std::vector<bool> Analyzer::GetAllAffectedItems(
     const std::set<const SourceFile*>& source_files) const {
-  std::set<const Item*> directly_affected_items;
-  for (auto* source_file : source_files)
-    AddItemsDirectlyReferringToFile(source_file, &directly_affected_items);
-
-  std::set<const Item*> all_affected_items;
-  for (auto* affected_item : directly_affected_items)
-    AddAllItemsReferringToItem(affected_item, &all_affected_items);
+  std::vector<bool> affected(all_items_.size());
+  std::vector<size_t> pending;
+  auto add_item = [&affected, &pending](size_t index) {
+    if (!affected[index]) {
+      affected[index] = true;
+      pending.push_back(index);
+    }
+  };
+
+  // Items directly referring to the files.
+  for (const SourceFile* file : source_files) {
+    auto found = files_to_items_.find(file->value());
+    if (found != files_to_items_.end()) {
+      for (size_t index : found->second)
+        add_item(index);
+    }
+    for (const auto& [dir, index] : data_directories_) {
+      if (file->value().starts_with(dir))
+        add_item(index);
+    }
+  }
 
-  return all_affected_items;
+  // Everything depending on them, transitively.
+  while (!pending.empty()) {
+    size_t index = pending.back();
+    pending.pop_back();
+    for (size_t i = dependents_begin_[index]; i < dependents_begin_[index + 1];
+         i++)
+      add_item(dependents_[i]);
+  }
+  return affected;
 }
 
 std::set<Label> Analyzer::InvalidLabels(const std::set<Label>& labels) const {
@@ -409,78 +528,60 @@ void Analyzer::FilterTarget(const Target* target,
   }
 }
 
-bool Analyzer::ItemRefersToFile(const Item* item,
-                                const SourceFile* file) const {
-  for (const auto& cur_file : item->build_dependency_files()) {
-    if (cur_file == *file)
-      return true;
-  }
+void Analyzer::AddFilesReferredToByItem(size_t index) {
+  const Item* item = all_items_[index];
+  for (const auto& cur_file : item->build_dependency_files())
+    AddFileReferredToByItem(cur_file.value(), index);
 
   if (const Config* config = item->AsConfig()) {
-    for (const auto& config_pair : config->configs()) {
-      if (ItemRefersToFile(config_pair.ptr, file))
-        return true;
-    }
+    for (const auto& config_pair : config->configs())
+      AddFilesReferredToByConfig(config_pair.ptr, index);
   }
 
-  if (!item->AsTarget())
-    return false;
-
   const Target* target = item->AsTarget();
-  for (const auto& cur_file : target->sources()) {
-    if (cur_file == *file)
-      return true;
-  }
-  for (const auto& cur_file : target->public_headers()) {
-    if (cur_file == *file)
-      return true;
-  }
+  if (!target)
+    return;
+
+  for (const auto& cur_file : target->sources())
+    AddFileReferredToByItem(cur_file.value(), index);
+  for (const auto& cur_file : target->public_headers())
+    AddFileReferredToByItem(cur_file.value(), index);
   for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
-    for (const auto& cur_file : iter.cur().inputs()) {
-      if (cur_file == *file)
-        return true;
-    }
+    for (const auto& cur_file : iter.cur().inputs())
+      AddFileReferredToByItem(cur_file.value(), index);
   }
   for (const auto& cur_file : target->data()) {
-    if (cur_file == file->value())
-      return true;
-    if (cur_file.back() == '/' && file->value().starts_with(cur_file))
-      return true;
+    if (!cur_file.empty() && cur_file.back() == '/')
+      data_directories_.emplace_back(cur_file, index);
+    else
+      AddFileReferredToByItem(cur_file, index);
   }
 
-  if (target->action_values().script().value() == file->value())
-    return true;
+  AddFileReferredToByItem(target->action_values().script().value(), index);
 
+  // Source file values are interned, so they outlive this temporary vector.
   std::vector<SourceFile> outputs;
   target->action_values().GetOutputsAsSourceFiles(target, &outputs);
-  for (const auto& cur_file : outputs) {
-    if (cur_file == *file)
-      return true;
-  }
-  return false;
+  for (const auto& cur_file : outputs)
+    AddFileReferredToByItem(cur_file.value(), index);
 }
 
-void Analyzer::AddItemsDirectlyReferringToFile(
-    const SourceFile* file,
-    std::set<const Item*>* directly_affected_items) const {
-  for (const auto* item : all_items_) {
-    if (ItemRefersToFile(item, file))
-      directly_affected_items->insert(item);
-  }
+void Analyzer::AddFilesReferredToByConfig(const Config* config, size_t index) {
+  for (const auto& cur_file : config->build_dependency_files())
+    AddFileReferredToByItem(cur_file.value(), index);
+  for (const auto& config_pair : config->configs())
+    AddFilesReferredToByConfig(config_pair.ptr, index);
 }
 
-void Analyzer::AddAllItemsReferringToItem(
-    const Item* item,
-    std::set<const Item*>* all_affected_items) const {
-  if (all_affected_items->find(item) != all_affected_items->end())
-    return;  // Already found this item.
-
-  all_affected_items->insert(item);
-
-  auto dep_begin = dep_map_.lower_bound(item);
-  auto dep_end = dep_map_.upper_bound(item);
-  for (auto cur_dep = dep_begin; cur_dep != dep_end; ++cur_dep)
-    AddAllItemsReferringToItem(cur_dep->second, all_affected_items);
+void Analyzer::AddFileReferredToByItem(std::string_view file, size_t index) {
+  if (file.empty())
+    return;
+  std::vector<size_t>& items = files_to_items_[file];
+  // An item can refer to a file several times, e.g. from both sources and
+  // inputs. Items are indexed one at a time so checking the last one is
+  // enough to list each item once.
+  if (items.empty() || items.back() != index)
+    items.push_back(index);
 }
 
 bool Analyzer::WereMainGNFilesModified(
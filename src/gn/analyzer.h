@@ -5,8 +5,12 @@
 #ifndef TOOLS_GN_ANALYZER_H_
 #define TOOLS_GN_ANALYZER_H_
 
+#include <memory>
 #include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "gn/builder.h"
@@ -15,6 +19,11 @@
 #include "gn/source_file.h"
 #include "gn/target.h"
 
+namespace base {
+class DictionaryValue;
+class Value;
+}  // namespace base
+
 // An Analyzer can answer questions about a build graph. It is used
 // to answer queries for the `refs` and `analyze` commands, where we
 // need to look at the graph in ways that can't easily be determined
@@ -32,12 +41,24 @@ class Analyzer {
   // to the files . See the help text for the analyze command (kAnalyze_Help)
   // for the specification of the input and output string formats and the
   // expected behavior of the method.
+  //
+  // The input may also be a list of such objects, in which case the output is
+  // the list of the corresponding results. The queries of a list share the
+  // work they have in common.
   std::string Analyze(const std::string& input, Err* err) const;
 
  private:
+  struct QueryCache;
+
+  // Answers one query of Analyze(), given as a parsed JSON value.
+  std::unique_ptr<base::DictionaryValue> AnalyzeQuery(
+      const base::Value& input,
+      QueryCache* cache) const;
+
   // Returns the set of all items that might be affected, directly or
-  // indirectly, by modifications to the given source files.
-  std::set<const Item*> GetAllAffectedItems(
+  // indirectly, by modifications to the given source files. The result is
+  // indexed like all_items_.
+  std::vector<bool> GetAllAffectedItems(
       const std::set<const SourceFile*>& source_files) const;
 
   // Returns the set of labels that do not refer to objects in the graph.
@@ -73,14 +94,11 @@ class Analyzer {
   // (see Filter(), above).
   void FilterTarget(const Target*, TargetSet* seen, TargetSet* filtered) const;
 
-  bool ItemRefersToFile(const Item* item, const SourceFile* file) const;
-
-  void AddItemsDirectlyReferringToFile(
-      const SourceFile* file,
-      std::set<const Item*>* affected_items) const;
-
-  void AddAllItemsReferringToItem(const Item* item,
-                                  std::set<const Item*>* affected_items) const;
+  // Adds the files referred to by the item at |index| of all_items_ to
+  // files_to_items_ and data_directories_.
+  void AddFilesReferredToByItem(size_t index);
+  void AddFilesReferredToByConfig(const Config* config, size_t index);
+  void AddFileReferredToByItem(std::string_view file, size_t index);
 
   // Main GN files stand for files whose context are used globally to execute
   // every other build files, this list includes dot file, build config file,
@@ -92,8 +110,20 @@ class Analyzer {
   std::map<Label, const Item*> labels_to_items_;
   Label default_toolchain_;
 
-  // Maps items to the list of items that depend on them.
-  std::multimap<const Item*, const Item*> dep_map_;
+  // The reverse dependency graph over the indices of all_items_, in
+  // compressed sparse row form: the items depending on all_items_[i] are at
+  // the indices dependents_[dependents_begin_[i]] to
+  // dependents_[dependents_begin_[i + 1] - 1].
+  std::vector<size_t> dependents_begin_;
+  std::vector<size_t> dependents_;
+
+  // Maps files to the indices of the items directly referring to them. The
+  // keys point to strings owned by the items or to interned strings.
+  std::unordered_map<std::string_view, std::vector<size_t>> files_to_items_;
+
+  // Data directories (with a trailing slash) and the index of the item
+  // referring to them. These refer to every file inside the directory.
+  std::vector<std::pair<std::string_view, size_t>> data_directories_;
 
   const SourceFile build_config_file_;
   const SourceFile dot_file_;
@@ -291,6 +291,37 @@ TEST_F(AnalyzerTest, TargetRefersToData) {
       "}");
 }
 
+// Tests that a target is marked as affected if a file inside one of its data
+// directories is modified.
+TEST_F(AnalyzerTest, TargetRefersToDataDirectory) {
+  std::unique_ptr<Target> t = MakeTarget("//dir", "target_name");
+  t->data().push_back("//dir/data/");
+  builder_.ItemDefined(std::move(t));
+  RunAnalyzerTest(
+      R"({
+       "files": [ "//dir/other/file.html" ],
+       "additional_compile_targets": [ "all" ],
+       "test_targets": [ "//dir:target_name" ]
+       })",
+      "{"
+      R"("compile_targets":[],)"
+      R"/("status":"No dependency",)/"
+      R"("test_targets":[])"
+      "}");
+
+  RunAnalyzerTest(
+      R"({
+       "files": [ "//dir/data/sub/file.html" ],
+       "additional_compile_targets": [ "all" ],
+       "test_targets": [ "//dir:target_name" ]
+       })",
+      "{"
+      R"("compile_targets":["all"],)"
+      R"/("status":"Found dependency",)/"
+      R"("test_targets":["//dir:target_name"])"
+      "}");
+}
+
 // Tests that a target is marked as affected if the target is an action and its
 // action script is modified.
 TEST_F(AnalyzerTest, TargetRefersToActionScript) {
@@ -751,4 +782,47 @@ TEST_F(AnalyzerTest, TargetAlternateToolchainRefersToSources) {
       "}");
 }
 
+// Tests that a list of queries is answered with the list of their results.
+TEST_F(AnalyzerTest, BatchQueries) {
+  std::unique_ptr<Target> t = MakeTarget("//dir", "target_name");
+  t->sources().push_back(SourceFile("//dir/file_name.cc"));
+  builder_.ItemDefined(std::move(t));
+  RunAnalyzerTest(
+      R"([{
+       "files": [ "//dir/file_name.cc" ],
+       "additional_compile_targets": [ "all" ],
+       "test_targets": [ "//dir:target_name" ]
+       }, {
+       "files": [ "//dir/other.cc" ],
+       "test_targets": [ "//dir:target_name" ]
+       }, {
+       "files": [ "//dir/file_name.cc" ],
+       "test_targets": [ ]
+       }, {
+       "files": [ "//dir/file_name.cc" ],
+       "test_targets": [ "//dir:missing" ]
+       }, 42])",
+      "["
+      "{"
+      R"("compile_targets":["all"],)"
+      R"/("status":"Found dependency",)/"
+      R"("test_targets":["//dir:target_name"])"
+      "},{"
+      R"("compile_targets":[],)"
+      R"/("status":"No dependency",)/"
+      R"("test_targets":[])"
+      "},{"
+      R"("compile_targets":[],)"
+      R"/("status":"No dependency",)/"
+      R"("test_targets":[])"
+      "},{"
+      R"("error":"Invalid targets",)"
+      R"("invalid_targets":["//dir:missing"])"
+      "},{"
+      R"("error":"Input is not a dictionary.",)"
+      R"("invalid_targets":[])"
+      "}"
+      "]");
+}
+
 }  // namespace gn_analyzer_unittest
@@ -18,6 +18,8 @@ BuildSettings::BuildSettings(const BuildSettings& other)
       secondary_source_path_(other.secondary_source_path_),
       python_path_(other.python_path_),
       ninja_required_version_(other.ninja_required_version_),
+      ninja_shared_flag_sets_(other.ninja_shared_flag_sets_),
+      ninja_target_shards_(other.ninja_target_shards_),
       build_config_file_(other.build_config_file_),
       arg_file_template_path_(other.arg_file_template_path_),
       build_dir_(other.build_dir_),
@@ -29,6 +31,7 @@ void BuildSettings::SetRootTargetLabel(const Label& r) {
 
 void BuildSettings::SetRootPatterns(std::vector<LabelPattern>&& patterns) {
   root_patterns_ = std::move(patterns);
+  root_patterns_matcher_ = LabelPatternMatcher(root_patterns_);
 }
 
 void BuildSettings::SetRootPath(const base::FilePath& r) {
@@ -15,6 +15,7 @@
 #include "gn/args.h"
 #include "gn/label.h"
 #include "gn/label_pattern.h"
+#include "gn/label_pattern_matcher.h"
 #include "gn/scope.h"
 #include "gn/source_dir.h"
 #include "gn/source_file.h"
@@ -42,6 +43,11 @@ class BuildSettings {
   }
   void SetRootPatterns(std::vector<LabelPattern>&& root_patterns);
 
+  // Matcher for root_patterns(), shared by all targets.
+  const LabelPatternMatcher& root_patterns_matcher() const {
+    return root_patterns_matcher_;
+  }
+
   // Absolute path of the source root on the local system. Everything is
   // relative to this. Does not end in a [back]slash.
   const base::FilePath& root_path() const { return root_path_; }
@@ -77,6 +83,22 @@ class BuildSettings {
     no_stamp_files_ = no_stamp_files;
   }
 
+  // The 'ninja_shared_flag_sets' boolean flag can be set to define the
+  // compiler flag values shared by several targets once in the toolchain's
+  // Ninja file, and reference them from the targets' Ninja files.
+  bool ninja_shared_flag_sets() const { return ninja_shared_flag_sets_; }
+  void set_ninja_shared_flag_sets(bool ninja_shared_flag_sets) {
+    ninja_shared_flag_sets_ = ninja_shared_flag_sets;
+  }
+
+  // The 'ninja_target_shards' integer can be set to pack the Ninja rules of
+  // the binary targets of each toolchain into this many shard files instead
+  // of one file per target. Zero (the default) disables sharding.
+  int ninja_target_shards() const { return ninja_target_shards_; }
+  void set_ninja_target_shards(int ninja_target_shards) {
+    ninja_target_shards_ = ninja_target_shards;
+  }
+
   const SourceFile& build_config_file() const { return build_config_file_; }
   void set_build_config_file(const SourceFile& f) { build_config_file_ = f; }
 
@@ -144,6 +166,7 @@ class BuildSettings {
  private:
   Label root_target_label_;
   std::vector<LabelPattern> root_patterns_;
+  LabelPatternMatcher root_patterns_matcher_;
   base::FilePath dotfile_name_;
   base::FilePath root_path_;
   std::string root_path_utf8_;
@@ -153,6 +176,8 @@ class BuildSettings {
   // See 40045b9 for the reason behind using 1.7.2 as the default version.
   Version ninja_required_version_{1, 7, 2};
   bool no_stamp_files_ = true;
+  bool ninja_shared_flag_sets_ = false;
+  int ninja_target_shards_ = 0;
 
   SourceFile build_config_file_;
   SourceFile arg_file_template_path_;
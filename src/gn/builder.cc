@@ -18,6 +18,7 @@
 #include "gn/settings.h"
 #include "gn/target.h"
 #include "gn/trace.h"
+#include "util/msg_loop.h"
 
 namespace {
 
@@ -60,15 +61,57 @@ Builder::Builder(Loader* loader) : loader_(loader) {}
 Builder::~Builder() = default;
 
 void Builder::ItemDefined(std::unique_ptr<Item> item) {
+  BuilderRecord::ItemType type = BuilderRecord::TypeOfItem(item.get());
+  auto pair = records_.try_emplace(item->label(), item->defined_from(), type);
+  DefineItem(std::move(item), pair.first, pair.second);
+}
+
+void Builder::ItemDefinedOnAnyThread(std::unique_ptr<Item> item) {
+  // Increment the work count for the duration of defining the item with the
+  // builder. Otherwise finishing this call will race finishing loading files.
+  // If there is no other pending work at any point before the item is defined
+  // on the main thread, the 'Complete' function will be signaled and we'll
+  // stop running with an incomplete build.
+  g_scheduler->IncrementWorkCount();
+
+  BuilderRecord::ItemType type = BuilderRecord::TypeOfItem(item.get());
+  auto pair = records_.try_emplace(item->label(), item->defined_from(), type);
+
+  bool was_empty;
+  {
+    std::lock_guard<std::mutex> lock(pending_items_lock_);
+    was_empty = pending_items_.empty();
+    pending_items_.push_back({std::move(item), pair.first, pair.second});
+  }
+  // A task is already pending otherwise, and will pick this item up.
+  if (was_empty)
+    g_scheduler->task_runner()->PostTask([this]() { DefinePendingItems(); });
+}
+
+void Builder::DefinePendingItems() {
+  std::vector<PendingItem> items;
+  {
+    std::lock_guard<std::mutex> lock(pending_items_lock_);
+    items.swap(pending_items_);
+  }
+  for (PendingItem& pending : items) {
+    DefineItem(std::move(pending.item), pending.record_created,
+               pending.record);
+    g_scheduler->DecrementWorkCount();
+  }
+}
+
+void Builder::DefineItem(std::unique_ptr<Item> item,
+                         bool record_created,
+                         BuilderRecord* record) {
   ScopedTrace trace(TraceItem::TRACE_DEFINE_TARGET, item->label());
   trace.SetToolchain(item->settings()->toolchain_label());
 
   BuilderRecord::ItemType type = BuilderRecord::TypeOfItem(item.get());
 
   Err err;
-  BuilderRecord* record =
-      GetOrCreateRecordOfType(item->label(), item->defined_from(), type, &err);
-  if (!record) {
+  if (!record_created &&
+      !CheckRecordType(record, type, item->defined_from(), &err)) {
     g_scheduler->FailWithError(err);
     return;
   }
@@ -175,8 +218,7 @@ std::vector<const Target*> Builder::GetAllResolvedTargets() const {
 }
 
 const BuilderRecord* Builder::GetRecord(const Label& label) const {
-  // Forward to the non-const version.
-  return const_cast<Builder*>(this)->GetRecord(label);
+  return records_.find(label);
 }
 
 BuilderRecord* Builder::GetRecord(const Label& label) {
@@ -331,25 +373,35 @@ BuilderRecord* Builder::GetOrCreateRecordOfType(const Label& label,
   BuilderRecord* record = pair.second;
 
   // Check types, if the record was not just created.
-  if (!pair.first && record->type() != type) {
-    std::string msg =
-        "The type of " + label.GetUserVisibleName(true) + "\nhere is a " +
-        BuilderRecord::GetNameForType(type) + " but was previously seen as a " +
-        BuilderRecord::GetNameForType(record->type()) +
-        ".\n\n"
-        "The most common cause is that the label of a config was put in the\n"
-        "in the deps section of a target (or vice-versa).";
-    *err = Err(request_from, "Item type does not match.", msg);
-    if (record->originally_referenced_from()) {
-      err->AppendSubErr(
-          Err(record->originally_referenced_from(), std::string()));
-    }
+  if (!pair.first && !CheckRecordType(record, type, request_from, err))
     return nullptr;
-  }
 
   return record;
 }
 
+bool Builder::CheckRecordType(const BuilderRecord* record,
+                              BuilderRecord::ItemType type,
+                              const ParseNode* request_from,
+                              Err* err) const {
+  if (record->type() == type)
+    return true;
+
+  std::string msg =
+      "The type of " + record->label().GetUserVisibleName(true) +
+      "\nhere is a " + BuilderRecord::GetNameForType(type) +
+      " but was previously seen as a " +
+      BuilderRecord::GetNameForType(record->type()) +
+      ".\n\n"
+      "The most common cause is that the label of a config was put in the\n"
+      "in the deps section of a target (or vice-versa).";
+  *err = Err(request_from, "Item type does not match.", msg);
+  if (record->originally_referenced_from()) {
+    err->AppendSubErr(
+        Err(record->originally_referenced_from(), std::string()));
+  }
+  return false;
+}
+
 BuilderRecord* Builder::GetResolvedRecordOfType(const Label& label,
                                                 const ParseNode* origin,
                                                 BuilderRecord::ItemType type,
@@ -517,10 +569,22 @@ bool Builder::ResolveItem(BuilderRecord* record, Err* err) {
       return false;
   }
 
-  record->set_resolved(true);
+  record->item()->set_resolved_index(resolved_item_count_++);
 
+  if (resolve_targets_on_worker_pool_ &&
+      record->type() == BuilderRecord::ITEM_TARGET) {
+    ScheduleTargetOnResolved(record);
+    return true;
+  }
+
+  record->set_resolved(true);
   if (!record->item()->OnResolved(err))
     return false;
+  return FinishResolveItem(record, err);
+}
+
+bool Builder::FinishResolveItem(BuilderRecord* record, Err* err) {
+  DCHECK(record->resolved());
   if (record->should_generate() && resolved_and_generated_callback_)
     resolved_and_generated_callback_(record);
 
@@ -537,6 +601,52 @@ bool Builder::ResolveItem(BuilderRecord* record, Err* err) {
   return true;
 }
 
+void Builder::ScheduleTargetOnResolved(BuilderRecord* record) {
+  // Once a target failed there is no point in resolving more of them, the
+  // error is reported as soon as the pending ones are done.
+  if (pending_resolve_error_.has_error())
+    return;
+
+  // The work count is held until the result is processed on the main thread,
+  // otherwise the scheduler could consider the work done in between.
+  pending_target_resolutions_++;
+  g_scheduler->IncrementWorkCount();
+
+  // Only the item is touched on the worker. Its dependencies are all resolved
+  // and are not modified anymore, and records are only updated on the main
+  // thread.
+  Item* item = record->item();
+  MsgLoop* task_runner = g_scheduler->task_runner();
+  g_scheduler->ScheduleWork([this, record, item, task_runner]() {
+    Err err;
+    item->OnResolved(&err);
+    task_runner->PostTask([this, record, err]() {
+      OnTargetResolvedOnWorkerPool(record, err);
+      g_scheduler->DecrementWorkCount();
+    });
+  });
+}
+
+void Builder::OnTargetResolvedOnWorkerPool(BuilderRecord* record,
+                                           const Err& err) {
+  DCHECK(pending_target_resolutions_ > 0);
+  pending_target_resolutions_--;
+
+  Err finish_err = err;
+  if (!finish_err.has_error()) {
+    record->set_resolved(true);
+    FinishResolveItem(record, &finish_err);
+  }
+  if (finish_err.has_error() &&
+      record->item()->resolved_index() < pending_resolve_error_index_) {
+    pending_resolve_error_ = finish_err;
+    pending_resolve_error_index_ = record->item()->resolved_index();
+  }
+
+  if (pending_target_resolutions_ == 0 && pending_resolve_error_.has_error())
+    g_scheduler->FailWithError(pending_resolve_error_);
+}
+
 bool Builder::ResolveDeps(LabelTargetVector* deps, Err* err) {
   for (LabelTargetPair& cur : *deps) {
     DCHECK(!cur.ptr);
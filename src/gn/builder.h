@@ -7,21 +7,25 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "gn/builder_record.h"
 #include "gn/builder_record_map.h"
+#include "gn/err.h"
 #include "gn/label.h"
 #include "gn/label_ptr.h"
 #include "gn/unique_vector.h"
 
 class ActionValues;
-class Err;
 class Loader;
 class ParseNode;
 
 // The builder assembles the dependency tree. It is not threadsafe and runs on
-// the main thread only. See also BuilderRecord.
+// the main thread only, except for ItemDefinedOnAnyThread() and for
+// Target::OnResolved() which may optionally run on the scheduler's worker pool
+// (see set_resolve_targets_on_worker_pool()). See also BuilderRecord.
 class Builder {
  public:
   using ResolvedGeneratedCallback = std::function<void(const BuilderRecord*)>;
@@ -36,10 +40,27 @@ class Builder {
     resolved_and_generated_callback_ = cb;
   }
 
+  // When set, Target::OnResolved() runs on the scheduler's worker pool so that
+  // targets whose dependencies are all resolved can be processed concurrently.
+  // Records are still only updated on the main thread: a target is marked
+  // resolved, and the records waiting on it are resolved, once its
+  // OnResolved() completes. This requires a running Scheduler and is off by
+  // default.
+  void set_resolve_targets_on_worker_pool(bool enabled) {
+    resolve_targets_on_worker_pool_ = enabled;
+  }
+
   Loader* loader() const { return loader_; }
 
   void ItemDefined(std::unique_ptr<Item> item);
 
+  // Same as ItemDefined() but may be called from any thread. The item's record
+  // is looked up or created on the calling thread, and the item is queued to
+  // be defined on the main thread. Items queued while the main thread is busy
+  // are defined together by a single task rather than one task each. Requires
+  // a running Scheduler, whose work count is held until the item is defined.
+  void ItemDefinedOnAnyThread(std::unique_ptr<Item> item);
+
   // Returns NULL if there is not a thing with the corresponding label.
   const Item* GetItem(const Label& label) const;
   const Toolchain* GetToolchain(const Label& label) const;
@@ -52,8 +73,13 @@ class Builder {
   // Returns targets which should be generated and which are defined.
   std::vector<const Target*> GetAllResolvedTargets() const;
 
+  // Returns the number of items resolved so far. This is one more than the
+  // largest Item::resolved_index().
+  size_t resolved_item_count() const { return resolved_item_count_; }
+
   // Returns the record for the given label, or NULL if it doesn't exist.
-  // Mostly used for unit tests.
+  // Mostly used for unit tests. The non-const version must be called from the
+  // main thread.
   const BuilderRecord* GetRecord(const Label& label) const;
   BuilderRecord* GetRecord(const Label& label);
 
@@ -64,6 +90,15 @@ class Builder {
   BuilderRecord* GetOrCreateRecordForTesting(const Label& label);
 
  private:
+  // Implementation of ItemDefined() once the item's record has been found or
+  // created.
+  void DefineItem(std::unique_ptr<Item> item,
+                  bool record_created,
+                  BuilderRecord* record);
+
+  // Defines all the items queued by ItemDefinedOnAnyThread().
+  void DefinePendingItems();
+
   bool TargetDefined(BuilderRecord* record, Err* err);
   bool ConfigDefined(BuilderRecord* record, Err* err);
   bool ToolchainDefined(BuilderRecord* record, Err* err);
@@ -79,6 +114,13 @@ class Builder {
                                          BuilderRecord::ItemType type,
                                          Err* err);
 
+  // Checks that an existing record has the given type, setting the error if
+  // not. request_from is used as the source of the error.
+  bool CheckRecordType(const BuilderRecord* record,
+                       BuilderRecord::ItemType type,
+                       const ParseNode* request_from,
+                       Err* err) const;
+
   // Returns the record associated with the given label. This function checks
   // that it's already been resolved to the correct type.
   //
@@ -122,6 +164,15 @@ class Builder {
   // target's Label*Vectors with the resolved pointers.
   bool ResolveItem(BuilderRecord* record, Err* err);
 
+  // Called once the item's OnResolved() succeeded. Runs the resolved callback
+  // and resolves every record that was only waiting on this one.
+  bool FinishResolveItem(BuilderRecord* record, Err* err);
+
+  // Runs the target's OnResolved() on the worker pool, then calls
+  // OnTargetResolvedOnWorkerPool() on the main thread.
+  void ScheduleTargetOnResolved(BuilderRecord* record);
+  void OnTargetResolvedOnWorkerPool(BuilderRecord* record, const Err& err);
+
   // Fills in the pointers in the given vector based on the labels. We assume
   // that everything should be resolved by this point, so will return an error
   // if anything isn't found or if the type doesn't match.
@@ -140,10 +191,35 @@ class Builder {
   // Non owning pointer.
   Loader* loader_;
 
-  BuilderRecordMap records_;
+  // Sharded so ItemDefinedOnAnyThread() can create records concurrently.
+  ShardedBuilderRecordMap records_;
+
+  // Items from ItemDefinedOnAnyThread() waiting to be defined on the main
+  // thread, in the order they were queued.
+  struct PendingItem {
+    std::unique_ptr<Item> item;
+    bool record_created;
+    BuilderRecord* record;
+  };
+  std::mutex pending_items_lock_;
+  std::vector<PendingItem> pending_items_;
 
   ResolvedGeneratedCallback resolved_and_generated_callback_;
 
+  size_t resolved_item_count_ = 0;
+
+  bool resolve_targets_on_worker_pool_ = false;
+
+  // Number of targets whose OnResolved() is running on the worker pool.
+  size_t pending_target_resolutions_ = 0;
+
+  // When targets fail on the worker pool, the error is held until all pending
+  // resolutions completed, and the one of the target that was scheduled first
+  // (lowest resolved index) is reported. This keeps the reported error
+  // independent of the order in which workers finish.
+  Err pending_resolve_error_;
+  size_t pending_resolve_error_index_ = Item::kNoResolvedIndex;
+
   Builder(const Builder&) = delete;
   Builder& operator=(const Builder&) = delete;
 };
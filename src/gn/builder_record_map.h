@@ -5,6 +5,11 @@
 #ifndef SRC_GN_BUILDER_RECORD_MAP_H_
 #define SRC_GN_BUILDER_RECORD_MAP_H_
 
+#include <stdint.h>
+
+#include <mutex>
+#include <utility>
+
 #include "gn/builder_record.h"
 #include "gn/hash_table_base.h"
 
@@ -77,4 +82,105 @@ class BuilderRecordMap : public HashTableBase<BuilderRecordNode> {
   }
 };
 
+// A BuilderRecordMap split into independently locked shards, so that records
+// can be looked up and created from several threads at once without them
+// contending on a single lock.
+//
+// Lookups and insertions are thread-safe. Iteration is not, and must only be
+// done once no other thread modifies the map anymore. Record pointers are
+// stable, but the records themselves are not synchronized by the map.
+class ShardedBuilderRecordMap {
+ private:
+  struct Shard {
+    mutable std::mutex lock;
+    BuilderRecordMap map;
+  };
+
+ public:
+  static constexpr size_t kShardBits = 4;
+  static constexpr size_t kShardCount = size_t(1) << kShardBits;
+
+  bool empty() const { return size() == 0; }
+
+  size_t size() const {
+    size_t result = 0;
+    for (const Shard& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.lock);
+      result += shard.map.size();
+    }
+    return result;
+  }
+
+  // See BuilderRecordMap::find().
+  BuilderRecord* find(const Label& label) const {
+    const Shard& shard = ShardFor(label);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    return shard.map.find(label);
+  }
+
+  // See BuilderRecordMap::try_emplace().
+  std::pair<bool, BuilderRecord*> try_emplace(const Label& label,
+                                              const ParseNode* request_from,
+                                              BuilderRecord::ItemType type) {
+    Shard& shard = ShardFor(label);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    return shard.map.try_emplace(label, request_from, type);
+  }
+
+  // Iteration support, visiting shards in turn.
+  struct const_iterator {
+    const BuilderRecord& operator*() const { return *it; }
+    const BuilderRecord* operator->() const { return &*it; }
+
+    const_iterator& operator++() {
+      ++it;
+      SkipEmptyShards();
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return shard == other.shard && (shard == shard_end || it == other.it);
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+    // Moves to the first record of the next non-empty shard if the current
+    // one has been fully visited.
+    void SkipEmptyShards() {
+      while (!it.valid() && ++shard != shard_end)
+        it = shard->map.begin();
+    }
+
+    const Shard* shard;
+    const Shard* shard_end;
+    BuilderRecordMap::const_iterator it;
+  };
+
+  const_iterator begin() const {
+    const_iterator result{shards_, shards_ + kShardCount,
+                          shards_[0].map.begin()};
+    result.SkipEmptyShards();
+    return result;
+  }
+  const_iterator end() const {
+    const Shard* shard_end = shards_ + kShardCount;
+    return {shard_end, shard_end, {}};
+  }
+
+ private:
+  // The low bits of the hash select the bucket within a shard, so the shard is
+  // taken from the high bits after mixing.
+  Shard& ShardFor(const Label& label) {
+    uint64_t mixed =
+        static_cast<uint64_t>(label.hash()) * UINT64_C(0x9E3779B97F4A7C15);
+    return shards_[mixed >> (64 - kShardBits)];
+  }
+  const Shard& ShardFor(const Label& label) const {
+    return const_cast<ShardedBuilderRecordMap*>(this)->ShardFor(label);
+  }
+
+  Shard shards_[kShardCount];
+};
+
 #endif  // SRC_GN_BUILDER_RECORD_MAP_H_
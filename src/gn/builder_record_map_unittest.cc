@@ -2,6 +2,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 
 #include "gn/builder_record_map.h"
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "gn/builder_record.h"
 #include "gn/label.h"
 #include "gn/source_dir.h"
@@ -60,3 +67,46 @@ TEST(BuilderRecordMap, TryEmplace) {
   EXPECT_TRUE(map.find(kLabel2));
   EXPECT_TRUE(map.find(kLabel3));
 }
+
+TEST(ShardedBuilderRecordMap, ConcurrentTryEmplace) {
+  constexpr int kThreads = 4;
+  constexpr int kLabels = 200;
+  std::vector<Label> labels;
+  for (int i = 0; i < kLabels; i++)
+    labels.emplace_back(SourceDir("//src/"), "t" + std::to_string(i));
+
+  // Every thread tries to create every record, only one must win each.
+  ShardedBuilderRecordMap map;
+  std::atomic<int> created_count(0);
+  std::atomic<int> mismatch_count(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&map, &labels, &created_count, &mismatch_count]() {
+      for (const Label& label : labels) {
+        auto ret = map.try_emplace(label, nullptr, BuilderRecord::ITEM_TARGET);
+        if (ret.first)
+          created_count++;
+        if (ret.second->label() != label)
+          mismatch_count++;
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(kLabels, created_count.load());
+  EXPECT_EQ(0, mismatch_count.load());
+  EXPECT_EQ(static_cast<size_t>(kLabels), map.size());
+  for (const Label& label : labels)
+    EXPECT_EQ(label, map.find(label)->label());
+
+  // Iteration visits every record of every shard exactly once.
+  std::set<Label> seen;
+  for (const BuilderRecord& record : map)
+    EXPECT_TRUE(seen.insert(record.label()).second);
+  EXPECT_EQ(static_cast<size_t>(kLabels), seen.size());
+
+  ShardedBuilderRecordMap empty_map;
+  EXPECT_TRUE(empty_map.empty());
+  EXPECT_TRUE(empty_map.begin() == empty_map.end());
+}
@@ -186,6 +186,83 @@ TEST_F(BuilderTest, BasicDeps) {
   EXPECT_TRUE(c_record->waiting_on_resolution().empty());
 }
 
+// Tests that resolved items get dense indices in resolution order.
+TEST_F(BuilderTest, ResolvedIndex) {
+  SourceDir toolchain_dir = settings_.toolchain_label().dir();
+  std::string toolchain_name = settings_.toolchain_label().name();
+
+  Label a_label(SourceDir("//a/"), "a", toolchain_dir, toolchain_name);
+  Label b_label(SourceDir("//b/"), "b", toolchain_dir, toolchain_name);
+
+  // A depends on B, so it can only be resolved after B.
+  Target* a = new Target(&settings_, a_label);
+  a->public_deps().push_back(LabelTargetPair(b_label));
+  a->set_output_type(Target::EXECUTABLE);
+  builder_.ItemDefined(std::unique_ptr<Item>(a));
+  Toolchain* toolchain = DefineToolchain();
+  EXPECT_EQ(1u, builder_.resolved_item_count());
+  EXPECT_EQ(Item::kNoResolvedIndex, a->resolved_index());
+
+  Target* b = new Target(&settings_, b_label);
+  b->set_output_type(Target::STATIC_LIBRARY);
+  b->visibility().SetPublic();
+  builder_.ItemDefined(std::unique_ptr<Item>(b));
+
+  EXPECT_EQ(3u, builder_.resolved_item_count());
+  EXPECT_EQ(0u, toolchain->resolved_index());
+  EXPECT_EQ(1u, b->resolved_index());
+  EXPECT_EQ(2u, a->resolved_index());
+}
+
+TEST_F(BuilderTest, ResolveTargetsOnWorkerPool) {
+  SourceDir toolchain_dir = settings_.toolchain_label().dir();
+  std::string toolchain_name = settings_.toolchain_label().name();
+
+  Label a_label(SourceDir("//a/"), "a", toolchain_dir, toolchain_name);
+  Label b_label(SourceDir("//b/"), "b", toolchain_dir, toolchain_name);
+
+  builder_.set_resolve_targets_on_worker_pool(true);
+  std::vector<const Item*> generated;
+  builder_.set_resolved_and_generated_callback(
+      [&generated](const BuilderRecord* record) {
+        if (record->item()->AsTarget())
+          generated.push_back(record->item());
+      });
+
+  // Keep the scheduler from completing until everything was defined.
+  scheduler().IncrementWorkCount();
+
+  Target* a = new Target(&settings_, a_label);
+  a->public_deps().push_back(LabelTargetPair(b_label));
+  a->set_output_type(Target::EXECUTABLE);
+  builder_.ItemDefined(std::unique_ptr<Item>(a));
+  DefineToolchain();
+
+  Target* b = new Target(&settings_, b_label);
+  b->set_output_type(Target::STATIC_LIBRARY);
+  b->visibility().SetPublic();
+  builder_.ItemDefined(std::unique_ptr<Item>(b));
+
+  // B's OnResolved() is pending on the worker pool, so A must still wait.
+  EXPECT_FALSE(builder_.GetRecord(b_label)->resolved());
+  EXPECT_FALSE(builder_.GetRecord(a_label)->resolved());
+
+  scheduler().DecrementWorkCount();
+  EXPECT_TRUE(scheduler().Run());
+
+  EXPECT_TRUE(builder_.GetRecord(b_label)->resolved());
+  EXPECT_TRUE(builder_.GetRecord(a_label)->resolved());
+  EXPECT_EQ(1u, b->resolved_index());
+  EXPECT_EQ(2u, a->resolved_index());
+
+  // OnResolved() ran for both, and in dependency order.
+  EXPECT_FALSE(a->computed_outputs().empty());
+  EXPECT_FALSE(b->computed_outputs().empty());
+  ASSERT_EQ(2u, generated.size());
+  EXPECT_EQ(b, generated[0]);
+  EXPECT_EQ(a, generated[1]);
+}
+
 TEST_F(BuilderTest, SortedUnresolvedDeps) {
   SourceDir toolchain_dir = settings_.toolchain_label().dir();
   std::string toolchain_name = settings_.toolchain_label().name();
@@ -0,0 +1,56 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/chunk_renderer.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util/worker_pool.h"
+
+void RenderChunksInOrder(size_t chunk_count,
+                         const std::function<void(size_t)>& render,
+                         const std::function<void(size_t)>& consume,
+                         size_t max_pending_chunks) {
+  if (max_pending_chunks == 0) {
+    // Enough to keep all threads busy while the calling thread consumes.
+    max_pending_chunks =
+        std::max(2u, 2 * std::thread::hardware_concurrency());
+  }
+
+  std::mutex lock;
+  std::condition_variable rendered_cv;
+  std::vector<bool> rendered(chunk_count);
+
+  // Declared after the state used by the tasks, so that it waits for them
+  // before the state is destroyed.
+  WorkerPool pool;
+  size_t posted = 0;
+  auto post_next = [&]() {
+    size_t chunk = posted++;
+    pool.PostTask([&render, &lock, &rendered_cv, &rendered, chunk]() {
+      render(chunk);
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        rendered[chunk] = true;
+      }
+      rendered_cv.notify_all();
+    });
+  };
+
+  while (posted < std::min(chunk_count, max_pending_chunks))
+    post_next();
+  for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      rendered_cv.wait(guard, [&rendered, chunk]() { return rendered[chunk]; });
+    }
+    if (posted < chunk_count)
+      post_next();
+    consume(chunk);
+  }
+}
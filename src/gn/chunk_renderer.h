@@ -0,0 +1,29 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_CHUNK_RENDERER_H_
+#define TOOLS_GN_CHUNK_RENDERER_H_
+
+#include <stddef.h>
+
+#include <functional>
+
+// Renders |chunk_count| chunks of an output on a worker pool, and calls
+// |consume| for each rendered chunk in order on the calling thread, as soon
+// as it and the chunks before it are rendered.
+//
+// At most |max_pending_chunks| chunks are rendered ahead of the next chunk to
+// consume, so the memory used by rendered chunks is bounded regardless of the
+// size of the whole output. Zero means a default based on the number of
+// threads.
+//
+// |render| is called from the worker threads with the index of the chunk to
+// render, and must only touch the state of that chunk. |consume| is typically
+// used to append the chunk to the output and free it.
+void RenderChunksInOrder(size_t chunk_count,
+                         const std::function<void(size_t)>& render,
+                         const std::function<void(size_t)>& consume,
+                         size_t max_pending_chunks = 0);
+
+#endif  // TOOLS_GN_CHUNK_RENDERER_H_
@@ -0,0 +1,44 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/chunk_renderer.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "util/test/test.h"
+
+TEST(ChunkRenderer, RenderChunksInOrder) {
+  constexpr size_t kChunks = 100;
+  constexpr size_t kMaxPending = 3;
+  std::vector<std::string> chunks(kChunks);
+  std::atomic<size_t> rendered{0};
+  size_t consumed = 0;
+  size_t max_pending = 0;
+  std::string output;
+
+  RenderChunksInOrder(
+      kChunks,
+      [&chunks, &rendered](size_t chunk) {
+        chunks[chunk] = std::to_string(chunk) + ",";
+        rendered++;
+      },
+      [&](size_t chunk) {
+        EXPECT_EQ(consumed, chunk);
+        max_pending = std::max(max_pending, rendered - consumed);
+        output += chunks[chunk];
+        chunks[chunk].clear();
+        consumed++;
+      },
+      kMaxPending);
+
+  std::string expected;
+  for (size_t i = 0; i < kChunks; i++)
+    expected += std::to_string(i) + ",";
+  EXPECT_EQ(expected, output);
+  EXPECT_EQ(kChunks, consumed);
+  // The next chunk is posted before consuming the current one.
+  EXPECT_LE(max_pending, kMaxPending + 1);
+}
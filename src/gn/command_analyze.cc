@@ -54,6 +54,11 @@ const char kAnalyze_Help[] =
 
      If "additional_compile_targets" is absent, it defaults to the empty list.
 
+  input_path may instead contain a JSON list of such objects to answer several
+  independent queries against the same build graph, which is much faster than
+  running the command once per query. The output is then a list containing
+  the result object of each query, in order.
+
   If input_path is -, input is read from stdin.
 
   output_path is a path indicating where the results of the command are to be
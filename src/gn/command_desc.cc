@@ -16,6 +16,7 @@
 #include "gn/commands.h"
 #include "gn/config.h"
 #include "gn/desc_builder.h"
+#include "gn/resolved_target_data.h"
 #include "gn/rust_variables.h"
 #include "gn/setup.h"
 #include "gn/standard_out.h"
@@ -325,6 +326,7 @@ void HandleProperty(const std::string& what,
 }
 
 bool PrintTarget(const Target* target,
+                 const ResolvedTargetData& resolved,
                  const std::string& what,
                  bool single_target,
                  const std::map<std::string, DescHandlerFunc>& handler_map,
@@ -332,7 +334,8 @@ bool PrintTarget(const Target* target,
                  bool tree,
                  bool blame) {
   std::unique_ptr<base::DictionaryValue> dict =
-      DescBuilder::DescriptionForTarget(target, what, all, tree, blame);
+      DescBuilder::DescriptionForTarget(target, resolved, what, all, tree,
+                                        blame);
   if (!what.empty() && dict->empty()) {
     OutputString("Don't know how to display \"" + what + "\" for \"" +
                  Target::GetStringForOutputType(target->output_type()) +
@@ -693,6 +696,9 @@ int RunDesc(const std::vector<std::string>& args) {
     return 1;
   }
 
+  // Shared by all descriptions, which may inherit values from the same deps.
+  ResolvedTargetData resolved;
+
   if (json) {
     // Convert all targets/configs to JSON, serialize and print them
     auto res = std::make_unique<base::DictionaryValue>();
@@ -702,7 +708,7 @@ int RunDesc(const std::vector<std::string>& args) {
             target->label().GetUserVisibleName(
                 target->settings()->default_toolchain_label()),
             DescBuilder::DescriptionForTarget(
-                target, what_to_print, cmdline->HasSwitch(kAll),
+                target, resolved, what_to_print, cmdline->HasSwitch(kAll),
                 cmdline->HasSwitch(kTree), cmdline->HasSwitch(kBlame)));
       }
     } else if (!config_matches.empty()) {
@@ -727,9 +733,9 @@ int RunDesc(const std::vector<std::string>& args) {
         OutputString("\n\n");
       printed_output = true;
 
-      if (!PrintTarget(target, what_to_print, !multiple_outputs, handlers,
-                       cmdline->HasSwitch(kAll), cmdline->HasSwitch(kTree),
-                       cmdline->HasSwitch(kBlame)))
+      if (!PrintTarget(target, resolved, what_to_print, !multiple_outputs,
+                       handlers, cmdline->HasSwitch(kAll),
+                       cmdline->HasSwitch(kTree), cmdline->HasSwitch(kBlame)))
         return 1;
     }
     for (const Config* config : config_matches) {
@@ -6,12 +6,17 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <memory>
 #include <sstream>
+#include <unordered_set>
 
 #include "base/command_line.h"
+#include "base/files/file_enumerator.h"
 #include "base/files/file_util.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
+#include "base/md5.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "gn/commands.h"
@@ -24,7 +29,9 @@
 #include "gn/string_utils.h"
 #include "gn/switches.h"
 #include "gn/tokenizer.h"
+#include "last_commit_position.h"
 #include "util/build_config.h"
+#include "util/worker_pool.h"
 
 #if defined(OS_WIN)
 #include <fcntl.h>
@@ -33,6 +40,7 @@
 
 namespace commands {
 
+const char kSwitchCache[] = "cache";
 const char kSwitchDryRun[] = "dry-run";
 const char kSwitchDumpTree[] = "dump-tree";
 const char kSwitchReadTree[] = "read-tree";
@@ -43,10 +51,13 @@ const char kSwitchTreeTypeText[] = "text";
 const char kFormat[] = "format";
 const char kFormat_HelpShort[] = "format: Format .gn files.";
 const char kFormat_Help[] =
-    R"(gn format [--dump-tree] (--stdin | <list of build_files...>)
+    R"(gn format [--dump-tree] (--stdin | <list of build_files or dirs...>)
 
   Formats .gn file to a standard format.
 
+  Directories are searched recursively for .gn and .gni files. Files are
+  formatted in parallel.
+
   The contents of some lists ('sources', 'deps', etc.) will be sorted to a
   canonical order. To suppress this, you can add a comment of the form "#
   NOSORT" immediately preceding the assignment. e.g.
@@ -59,6 +70,13 @@ const char kFormat_Help[] =
 
 Arguments
 
+  --cache=<file>
+      Remembers the content hashes of files known to be formatted in <file>.
+      Files whose content matches a hash from the previous run are not parsed
+      again. The cache is ignored if it was written by a different version of
+      GN, and only keeps the most recently seen 100000 hashes. Not used with
+      --dump-tree.
+
   --dry-run
       Prints the list of files that would be reformatted but does not write
       anything to disk. This is useful for presubmit/lint-type checks.
@@ -85,6 +103,7 @@ Examples
   gn format some\\BUILD.gn
   gn format /abspath/some/BUILD.gn
   gn format --stdin
+  gn format --dry-run --cache=out/format.cache //some/dir
   gn format --read-tree=json //rewritten/BUILD.gn
 )";
 
@@ -1255,6 +1274,180 @@ void DoFormat(const ParseNode* root,
   *output = pr.String();
 }
 
+// Tokenizes, parses and formats the contents of |file|. Errors are returned in
+// |err| rather than printed, so this can be called from multiple threads. The
+// error refers to |file|, which must outlive it.
+bool FormatStringToStringWithErr(const InputFile* file,
+                                 TreeDumpMode dump_tree,
+                                 std::string* output,
+                                 std::string* dump_output,
+                                 Err* err) {
+  // Tokenize.
+  std::vector<Token> tokens =
+      Tokenizer::Tokenize(file, err, WhitespaceTransform::kInvalidToSpace);
+  if (err->has_error())
+    return false;
+
+  // Parse.
+  std::unique_ptr<ParseNode> parse_node = Parser::Parse(tokens, err);
+  if (err->has_error())
+    return false;
+
+  DoFormat(parse_node.get(), dump_tree, output, dump_output);
+  return true;
+}
+
+// A file to format, and the name to report it as.
+struct FileToFormat {
+  std::string name;
+  base::FilePath path;
+};
+
+// The outcome of formatting one file. Output is reported in order once all
+// files have been formatted.
+struct FormatFileResult {
+  // The formatted file. Kept alive for the locations of |err|.
+  std::unique_ptr<InputFile> input_file;
+  Err err;
+  std::string dump_output;
+
+  // Whether the formatted output differs from the file contents.
+  bool changed = false;
+
+  // The content hash of the file if it is known to be formatted after this
+  // run, for the cache.
+  std::string formatted_hash;
+};
+
+// Adds the files to format for the command line argument |arg|, which is
+// either a file or a directory searched for .gn and .gni files.
+bool AddFilesToFormat(const SourceDir& source_dir,
+                      const BuildSettings& build_settings,
+                      const std::string& arg,
+                      std::vector<FileToFormat>* files,
+                      Err* err) {
+  SourceFile file = source_dir.ResolveRelativeFile(Value(nullptr, arg), err);
+  if (err->has_error())
+    return false;
+
+  base::FilePath path = build_settings.GetFullPath(file);
+  if (!base::DirectoryExists(path)) {
+    files->push_back({arg, path});
+    return true;
+  }
+
+  std::vector<base::FilePath> found;
+  base::FileEnumerator enumerator(path, true, base::FileEnumerator::FILES);
+  for (base::FilePath cur = enumerator.Next(); !cur.empty();
+       cur = enumerator.Next()) {
+    base::FilePath::StringType extension = cur.FinalExtension();
+    if (extension == FILE_PATH_LITERAL(".gn") ||
+        extension == FILE_PATH_LITERAL(".gni"))
+      found.push_back(cur);
+  }
+  std::sort(found.begin(), found.end());
+
+  base::FilePath arg_path = UTF8ToFilePath(arg);
+  for (const base::FilePath& cur : found) {
+    base::FilePath name = arg_path;
+    path.AppendRelativePath(cur, &name);
+    files->push_back({FilePathToUTF8(name), cur});
+  }
+  return true;
+}
+
+// The header of the --cache file. Formatting may change between versions, so
+// hashes are only valid for the version that wrote them.
+std::string GetFormatCacheHeader() {
+  return std::string("gn format cache v1 ") + LAST_COMMIT_POSITION;
+}
+
+// Returns the hashes of the given cache file, most recent first, or nothing if
+// it doesn't exist or was written by another version.
+std::vector<std::string> ReadFormatCache(const base::FilePath& path) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return {};
+
+  std::vector<std::string> lines = base::SplitString(
+      contents, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  if (lines.empty() || lines[0] != GetFormatCacheHeader())
+    return {};
+  lines.erase(lines.begin());
+  return lines;
+}
+
+// Writes the hashes of the current run followed by the previous ones, up to
+// kMaxFormatCacheEntries.
+void WriteFormatCache(const base::FilePath& path,
+                      const std::vector<std::string>& current,
+                      const std::vector<std::string>& previous) {
+  std::unordered_set<std::string> written;
+  std::string new_cache = GetFormatCacheHeader() + "\n";
+  for (const auto* hashes : {&current, &previous}) {
+    for (const std::string& hash : *hashes) {
+      if (written.size() == kMaxFormatCacheEntries)
+        break;
+      if (written.insert(hash).second)
+        new_cache += hash + "\n";
+    }
+  }
+  // The cache is only an optimization, so failing to write it is ignored.
+  base::WriteFile(path, new_cache.data(), static_cast<int>(new_cache.size()));
+}
+
+void FormatFile(const FileToFormat& file,
+                TreeDumpMode dump_tree,
+                bool dry_run,
+                const std::unordered_set<std::string>& cache,
+                FormatFileResult* result) {
+  std::string original_contents;
+  if (!base::ReadFileToString(file.path, &original_contents)) {
+    result->err = Err(Location(), std::string("Couldn't read \"") +
+                                      FilePathToUTF8(file.path));
+    return;
+  }
+
+  std::string hash;
+  if (dump_tree == TreeDumpMode::kInactive) {
+    hash = base::MD5String(original_contents);
+    if (cache.find(hash) != cache.end()) {
+      result->formatted_hash = std::move(hash);
+      return;
+    }
+  }
+
+  result->input_file = std::make_unique<InputFile>(SourceFile());
+  result->input_file->SetContents(original_contents);
+  std::string output_string;
+  if (!FormatStringToStringWithErr(result->input_file.get(), dump_tree,
+                                   &output_string, &result->dump_output,
+                                   &result->err)) {
+    return;
+  }
+  if (dump_tree != TreeDumpMode::kInactive)
+    return;
+
+  if (original_contents == output_string) {
+    result->formatted_hash = std::move(hash);
+    return;
+  }
+  result->changed = true;
+  if (dry_run)
+    return;
+
+  // Update the file in-place.
+  if (base::WriteFile(file.path, output_string.data(),
+                      static_cast<int>(output_string.size())) == -1) {
+    result->err =
+        Err(Location(),
+            std::string("Failed to write formatted output back to \"") +
+                FilePathToUTF8(file.path) + std::string("\"."));
+    return;
+  }
+  result->formatted_hash = base::MD5String(output_string);
+}
+
 }  // namespace
 
 bool FormatJsonToString(const std::string& json, std::string* output) {
@@ -1273,22 +1466,11 @@ bool FormatStringToString(const std::string& input,
   InputFile file(source_file);
   file.SetContents(input);
   Err err;
-  // Tokenize.
-  std::vector<Token> tokens =
-      Tokenizer::Tokenize(&file, &err, WhitespaceTransform::kInvalidToSpace);
-  if (err.has_error()) {
-    err.PrintToStdout();
-    return false;
-  }
-
-  // Parse.
-  std::unique_ptr<ParseNode> parse_node = Parser::Parse(tokens, &err);
-  if (err.has_error()) {
+  if (!FormatStringToStringWithErr(&file, dump_tree, output, dump_output,
+                                   &err)) {
     err.PrintToStdout();
     return false;
   }
-
-  DoFormat(parse_node.get(), dump_tree, output, dump_output);
   return true;
 }
 
@@ -1396,63 +1578,78 @@ int RunFormat(const std::vector<std::string>& args) {
     return 0;
   }
 
-  // TODO(scottmg): Eventually, this list of files should be processed in
-  // parallel.
+  return FormatFiles(
+      setup.build_settings(), source_dir, args, dump_tree, dry_run, quiet,
+      base::CommandLine::ForCurrentProcess()->GetSwitchValuePath(kSwitchCache),
+      nullptr);
+}
+
+int FormatFiles(const BuildSettings& build_settings,
+                const SourceDir& source_dir,
+                const std::vector<std::string>& args,
+                TreeDumpMode dump_tree,
+                bool dry_run,
+                bool quiet,
+                const base::FilePath& cache_path,
+                std::vector<std::string>* changed) {
   int exit_code = 0;
+  std::vector<FileToFormat> files;
   for (const auto& arg : args) {
     Err err;
-    SourceFile file = source_dir.ResolveRelativeFile(Value(nullptr, arg), &err);
-    if (err.has_error()) {
+    if (!AddFilesToFormat(source_dir, build_settings, arg, &files, &err)) {
       err.PrintToStdout();
       exit_code = 1;
-      continue;
     }
+  }
 
-    base::FilePath to_format = setup.build_settings().GetFullPath(file);
-    std::string original_contents;
-    if (!base::ReadFileToString(to_format, &original_contents)) {
-      Err(Location(),
-          std::string("Couldn't read \"") + FilePathToUTF8(to_format))
-          .PrintToStdout();
-      exit_code = 1;
-      continue;
+  bool use_cache = !cache_path.empty() && dump_tree == TreeDumpMode::kInactive;
+  std::vector<std::string> previous_hashes;
+  if (use_cache)
+    previous_hashes = ReadFormatCache(cache_path);
+  std::unordered_set<std::string> cache(previous_hashes.begin(),
+                                        previous_hashes.end());
+
+  // Files are formatted in parallel, then reported in order.
+  std::vector<FormatFileResult> results(files.size());
+  {
+    // The pool waits for all posted tasks when it goes out of scope.
+    WorkerPool pool;
+    for (size_t i = 0; i < files.size(); i++) {
+      pool.PostTask([&files, &results, &cache, dump_tree, dry_run, i]() {
+        FormatFile(files[i], dump_tree, dry_run, cache, &results[i]);
+      });
     }
+  }
 
-    std::string output_string;
-    std::string dump_output_string;
-    if (!FormatStringToString(original_contents, dump_tree, &output_string,
-                              &dump_output_string)) {
+  std::vector<std::string> current_hashes;
+  for (size_t i = 0; i < files.size(); i++) {
+    const FormatFileResult& result = results[i];
+    if (!result.formatted_hash.empty())
+      current_hashes.push_back(result.formatted_hash);
+    if (result.err.has_error()) {
+      result.err.PrintToStdout();
       exit_code = 1;
       continue;
     }
-    printf("%s", dump_output_string.c_str());
-    if (dump_tree == TreeDumpMode::kInactive) {
-      if (dry_run) {
-        if (original_contents != output_string) {
-          printf("%s\n", arg.c_str());
-          exit_code = 2;
-        }
-        continue;
-      }
-      // Update the file in-place.
-      if (original_contents != output_string) {
-        if (base::WriteFile(to_format, output_string.data(),
-                            static_cast<int>(output_string.size())) == -1) {
-          Err(Location(),
-              std::string("Failed to write formatted output back to \"") +
-                  FilePathToUTF8(to_format) + std::string("\"."))
-              .PrintToStdout();
-          exit_code = 1;
-          continue;
-        }
-        if (!quiet) {
-          printf("Wrote formatted to '%s'.\n",
-                 FilePathToUTF8(to_format).c_str());
-        }
-      }
+    printf("%s", result.dump_output.c_str());
+    if (!result.changed)
+      continue;
+    if (changed)
+      changed->push_back(files[i].name);
+    if (dry_run) {
+      printf("%s\n", files[i].name.c_str());
+      exit_code = 2;
+    } else if (!quiet) {
+      printf("Wrote formatted to '%s'.\n",
+             FilePathToUTF8(files[i].path).c_str());
     }
   }
 
+  // Hashes identify contents rather than files, so the entries of previous
+  // runs stay valid for the files not formatted by this run.
+  if (use_cache)
+    WriteFormatCache(cache_path, current_hashes, previous_hashes);
+
   return exit_code;
 }
 
@@ -5,11 +5,20 @@
 #ifndef TOOLS_GN_COMAND_FORMAT_H_
 #define TOOLS_GN_COMAND_FORMAT_H_
 
+#include <stddef.h>
+
 #include <string>
+#include <vector>
 
+class BuildSettings;
 class Setup;
+class SourceDir;
 class SourceFile;
 
+namespace base {
+class FilePath;
+}
+
 namespace commands {
 
 enum class TreeDumpMode {
@@ -31,6 +40,26 @@ bool FormatStringToString(const std::string& input,
                           std::string* output,
                           std::string* dump_output);
 
+// The maximum number of content hashes kept in a --cache file. The hashes of
+// the current run come first, followed by those of previous runs, so the
+// oldest entries are dropped once the file is full.
+inline constexpr size_t kMaxFormatCacheEntries = 100000;
+
+// Formats the files named by |args| in place, in parallel. Each argument is a
+// file, or a directory searched for .gn and .gni files, resolved relative to
+// |source_dir|. With |dry_run|, files are only compared to their formatted
+// output. Unless |cache_path| is empty, it records the hashes of formatted
+// files between runs. The names of the files that need formatting are added
+// to |changed| if it is non-null. Returns the exit code of `gn format`.
+int FormatFiles(const BuildSettings& build_settings,
+                const SourceDir& source_dir,
+                const std::vector<std::string>& args,
+                TreeDumpMode dump_tree,
+                bool dry_run,
+                bool quiet,
+                const base::FilePath& cache_path,
+                std::vector<std::string>* changed);
+
 }  // namespace commands
 
 #endif  // TOOLS_GN_COMAND_FORMAT_H_
@@ -5,8 +5,14 @@
 #include "gn/command_format.h"
 
 #include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/md5.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
+#include "gn/build_settings.h"
 #include "gn/commands.h"
+#include "gn/filesystem_utils.h"
 #include "gn/setup.h"
 #include "gn/test_with_scheduler.h"
 #include "util/exe_path.h"
@@ -137,3 +143,181 @@ FORMAT_TEST(081)
 FORMAT_TEST(082)
 FORMAT_TEST(083)
 FORMAT_TEST(084)
+
+namespace {
+
+const char kUnformatted[] = "a=[\"b\",\n\"c\"]\n";
+const char kFormatted[] = "a = [\n  \"b\",\n  \"c\",\n]\n";
+
+// Formats files in a temporary source root.
+class FormatFilesTest : public FormatTest {
+ public:
+  FormatFilesTest() {
+    EXPECT_TRUE(temp_dir_.CreateUniqueTempDir());
+    build_settings_.SetRootPath(temp_dir_.GetPath());
+  }
+
+  base::FilePath Path(const std::string& name) const {
+    return temp_dir_.GetPath().Append(UTF8ToFilePath(name));
+  }
+
+  void WriteFile(const std::string& name, const std::string& contents) {
+    base::FilePath path = Path(name);
+    ASSERT_TRUE(base::CreateDirectory(path.DirName()));
+    ASSERT_EQ(static_cast<int>(contents.size()),
+              base::WriteFile(path, contents.data(),
+                              static_cast<int>(contents.size())));
+  }
+
+  std::string ReadFile(const std::string& name) const {
+    std::string contents;
+    base::ReadFileToString(Path(name), &contents);
+    return contents;
+  }
+
+  int Format(const std::vector<std::string>& args,
+             bool dry_run,
+             const base::FilePath& cache_path,
+             std::vector<std::string>* changed) {
+    return commands::FormatFiles(build_settings_, SourceDir("//"), args,
+                                 commands::TreeDumpMode::kInactive, dry_run,
+                                 true, cache_path, changed);
+  }
+
+  // Returns the hashes of the cache file, without its header.
+  std::vector<std::string> ReadCache(const std::string& name) const {
+    std::vector<std::string> lines = base::SplitString(
+        ReadFile(name), "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    if (!lines.empty())
+      lines.erase(lines.begin());
+    return lines;
+  }
+
+ private:
+  base::ScopedTempDir temp_dir_;
+  BuildSettings build_settings_;
+};
+
+}  // namespace
+
+TEST_F(FormatFilesTest, Directory) {
+  WriteFile("a/BUILD.gn", kUnformatted);
+  WriteFile("a/b/c.gni", kUnformatted);
+  WriteFile("a/b/notes.txt", kUnformatted);
+  WriteFile("other/BUILD.gn", kUnformatted);
+
+  std::vector<std::string> changed;
+  EXPECT_EQ(0, Format({"//a"}, false, base::FilePath(), &changed));
+  EXPECT_EQ((std::vector<std::string>{"//a/BUILD.gn", "//a/b/c.gni"}),
+            changed);
+  EXPECT_EQ(kFormatted, ReadFile("a/BUILD.gn"));
+  EXPECT_EQ(kFormatted, ReadFile("a/b/c.gni"));
+  EXPECT_EQ(kUnformatted, ReadFile("a/b/notes.txt"));
+  EXPECT_EQ(kUnformatted, ReadFile("other/BUILD.gn"));
+}
+
+TEST_F(FormatFilesTest, Parallel) {
+  std::vector<std::string> args;
+  for (int i = 0; i < 50; i++) {
+    std::string name = "f" + base::NumberToString(i) + ".gn";
+    WriteFile(name, i % 2 ? kUnformatted : kFormatted);
+    args.push_back("//" + name);
+  }
+
+  std::vector<std::string> changed;
+  EXPECT_EQ(0, Format(args, false, base::FilePath(), &changed));
+  // Changed files are reported in argument order.
+  ASSERT_EQ(25u, changed.size());
+  for (int i = 0; i < 25; i++) {
+    EXPECT_EQ("//f" + base::NumberToString(2 * i + 1) + ".gn", changed[i]);
+  }
+  for (int i = 0; i < 50; i++)
+    EXPECT_EQ(kFormatted, ReadFile("f" + base::NumberToString(i) + ".gn"));
+}
+
+TEST_F(FormatFilesTest, DryRun) {
+  WriteFile("formatted.gn", kFormatted);
+  WriteFile("unformatted.gn", kUnformatted);
+
+  std::vector<std::string> changed;
+  EXPECT_EQ(2, Format({"//formatted.gn", "//unformatted.gn"}, true,
+                      base::FilePath(), &changed));
+  EXPECT_EQ(std::vector<std::string>{"//unformatted.gn"}, changed);
+  EXPECT_EQ(kUnformatted, ReadFile("unformatted.gn"));
+
+  changed.clear();
+  EXPECT_EQ(0, Format({"//formatted.gn"}, true, base::FilePath(), &changed));
+  EXPECT_TRUE(changed.empty());
+}
+
+TEST_F(FormatFilesTest, Cache) {
+  WriteFile("formatted.gn", kFormatted);
+  WriteFile("unformatted.gn", kUnformatted);
+  base::FilePath cache_path = Path("format.cache");
+
+  // Only the hashes of formatted contents are written.
+  EXPECT_EQ(2, Format({"//formatted.gn", "//unformatted.gn"}, true, cache_path,
+                      nullptr));
+  EXPECT_EQ(std::vector<std::string>{base::MD5String(kFormatted)},
+            ReadCache("format.cache"));
+
+  // Files whose contents are in the cache are not parsed again, so a cached
+  // hash of unformatted contents hides the changes.
+  std::string header = ReadFile("format.cache");
+  header.erase(header.find('\n') + 1);
+  WriteFile("format.cache", header + base::MD5String(kUnformatted) + "\n");
+  std::vector<std::string> changed;
+  EXPECT_EQ(0, Format({"//unformatted.gn"}, true, cache_path, &changed));
+  EXPECT_TRUE(changed.empty());
+
+  // Entries of previous runs are merged after those of the current run.
+  WriteFile("other.gn", "b = 1\n");
+  EXPECT_EQ(0, Format({"//other.gn"}, false, cache_path, nullptr));
+  EXPECT_EQ((std::vector<std::string>{base::MD5String("b = 1\n"),
+                                      base::MD5String(kUnformatted)}),
+            ReadCache("format.cache"));
+
+  // A cache written by another version is ignored and replaced.
+  WriteFile("format.cache", "gn format cache v0\n" +
+                                base::MD5String(kUnformatted) + "\n");
+  changed.clear();
+  EXPECT_EQ(2, Format({"//unformatted.gn"}, true, cache_path, &changed));
+  EXPECT_EQ(std::vector<std::string>{"//unformatted.gn"}, changed);
+  EXPECT_TRUE(ReadCache("format.cache").empty());
+}
+
+TEST_F(FormatFilesTest, CacheSize) {
+  WriteFile("formatted.gn", kFormatted);
+  base::FilePath cache_path = Path("format.cache");
+  EXPECT_EQ(0, Format({"//formatted.gn"}, true, cache_path, nullptr));
+
+  // Fill the cache with the hashes of older runs.
+  std::string cache = ReadFile("format.cache");
+  for (size_t i = 0; i < commands::kMaxFormatCacheEntries; i++)
+    cache += base::MD5String(base::NumberToString(i)) + "\n";
+  WriteFile("format.cache", cache);
+
+  // The oldest entries are dropped, and the current run's come first.
+  WriteFile("other.gn", "b = 1\n");
+  EXPECT_EQ(0, Format({"//other.gn"}, true, cache_path, nullptr));
+  std::vector<std::string> hashes = ReadCache("format.cache");
+  ASSERT_EQ(commands::kMaxFormatCacheEntries, hashes.size());
+  EXPECT_EQ(base::MD5String("b = 1\n"), hashes[0]);
+  EXPECT_EQ(base::MD5String(kFormatted), hashes[1]);
+  EXPECT_EQ(base::MD5String(base::NumberToString(
+                commands::kMaxFormatCacheEntries - 3)),
+            hashes.back());
+}
+
+// Errors are reported after all files are formatted, so they must keep the
+// input file their location refers to alive.
+TEST_F(FormatFilesTest, UnclosedBracket) {
+  WriteFile("broken.gn", "a = [\n");
+  WriteFile("formatted.gn", kFormatted);
+
+  std::vector<std::string> changed;
+  EXPECT_EQ(1, Format({"//broken.gn", "//formatted.gn"}, false,
+                      base::FilePath(), &changed));
+  EXPECT_TRUE(changed.empty());
+  EXPECT_EQ("a = [\n", ReadFile("broken.gn"));
+}
@@ -5,8 +5,6 @@
 #include <inttypes.h>
 
 #include <mutex>
-#include <thread>
-#include <unordered_map>
 
 #include "base/command_line.h"
 #include "base/strings/string_number_conversions.h"
@@ -16,6 +14,7 @@
 #include "gn/commands.h"
 #include "gn/compile_commands_writer.h"
 #include "gn/eclipse_writer.h"
+#include "gn/file_write_queue.h"
 #include "gn/filesystem_utils.h"
 #include "gn/json_project_writer.h"
 #include "gn/label_pattern.h"
@@ -23,6 +22,7 @@
 #include "gn/ninja_target_writer.h"
 #include "gn/ninja_tools.h"
 #include "gn/ninja_writer.h"
+#include "gn/output_manifest.h"
 #include "gn/qt_creator_writer.h"
 #include "gn/runtime_deps.h"
 #include "gn/rust_project_writer.h"
@@ -89,25 +89,30 @@ struct TargetWriteInfo {
 
   NinjaOutputsMap ninja_outputs_map;
 
-  using ResolvedMap = std::unordered_map<std::thread::id, ResolvedTargetData>;
-  std::unique_ptr<ResolvedMap> resolved_map = std::make_unique<ResolvedMap>();
+  // The files written by the previous run, used to skip reading back
+  // unchanged target ninja files.
+  OutputManifest manifest;
 
-  void LeakOnPurpose() { (void)resolved_map.release(); }
+  // Writes the target ninja files off the worker threads.
+  FileWriteQueue write_queue{FileWriteQueue::kDefaultThreadCount, &manifest};
+
+  // Shared by all worker threads, so the data of each target is computed only
+  // once.
+  std::unique_ptr<ResolvedTargetData> resolved =
+      std::make_unique<ResolvedTargetData>();
+
+  void LeakOnPurpose() { (void)resolved.release(); }
 };
 
 // Called on worker thread to write the ninja file.
 void BackgroundDoWrite(TargetWriteInfo* write_info, const Target* target) {
-  ResolvedTargetData* resolved;
   std::vector<OutputFile> target_ninja_outputs;
   std::vector<OutputFile>* ninja_outputs =
       write_info->want_ninja_outputs ? &target_ninja_outputs : nullptr;
 
-  {
-    std::lock_guard<std::mutex> lock(write_info->lock);
-    resolved = &((*write_info->resolved_map)[std::this_thread::get_id()]);
-  }
-  std::string rule =
-      NinjaTargetWriter::RunAndWriteFile(target, resolved, ninja_outputs);
+  std::string rule = NinjaTargetWriter::RunAndWriteFile(
+      target, write_info->resolved.get(), ninja_outputs,
+      &write_info->write_queue);
 
   DCHECK(!rule.empty());
 
@@ -769,6 +774,10 @@ int RunGen(const std::vector<std::string>& args) {
   write_info.want_ninja_outputs =
       command_line->HasSwitch(kSwitchNinjaOutputsFile);
 
+  base::FilePath manifest_path = setup->build_settings().GetFullPath(
+      OutputManifest::GetManifestFile(&setup->build_settings()));
+  write_info.manifest.Load(manifest_path);
+
   setup->builder().set_resolved_and_generated_callback(
       [&write_info](const BuilderRecord* record) {
         ItemResolvedAndGeneratedCallback(&write_info, record);
@@ -794,6 +803,12 @@ int RunGen(const std::vector<std::string>& args) {
   }
 
   Err err;
+  if (!write_info.write_queue.Wait(&err) ||
+      !write_info.manifest.Save(manifest_path, &err)) {
+    err.PrintToStdout();
+    return 1;
+  }
+
   // Write the root ninja files.
   if (!NinjaWriter::RunAndWriteFiles(&setup->build_settings(), setup->builder(),
                                      write_info.rules, &err)) {
@@ -20,6 +20,7 @@
 #include "gn/item.h"
 #include "gn/label.h"
 #include "gn/label_pattern.h"
+#include "gn/label_pattern_matcher.h"
 #include "gn/ninja_build_writer.h"
 #include "gn/setup.h"
 #include "gn/standard_out.h"
@@ -623,43 +624,30 @@ bool ResolveFromCommandLineInput(
 void FilterTargetsByPatterns(const std::vector<const Target*>& input,
                              const std::vector<LabelPattern>& filter,
                              std::vector<const Target*>* output) {
+  LabelPatternMatcher matcher(filter);
   for (auto* target : input) {
-    for (const auto& pattern : filter) {
-      if (pattern.Matches(target->label())) {
-        output->push_back(target);
-        break;
-      }
-    }
+    if (matcher.Matches(target->label()))
+      output->push_back(target);
   }
 }
 
 void FilterTargetsByPatterns(const std::vector<const Target*>& input,
                              const std::vector<LabelPattern>& filter,
                              UniqueVector<const Target*>* output) {
+  LabelPatternMatcher matcher(filter);
   for (auto* target : input) {
-    for (const auto& pattern : filter) {
-      if (pattern.Matches(target->label())) {
-        output->push_back(target);
-        break;
-      }
-    }
+    if (matcher.Matches(target->label()))
+      output->push_back(target);
   }
 }
 
 void FilterOutTargetsByPatterns(const std::vector<const Target*>& input,
                                 const std::vector<LabelPattern>& filter,
                                 std::vector<const Target*>* output) {
+  LabelPatternMatcher matcher(filter);
   for (auto* target : input) {
-    bool match = false;
-    for (const auto& pattern : filter) {
-      if (pattern.Matches(target->label())) {
-        match = true;
-        break;
-      }
-    }
-    if (!match) {
+    if (!matcher.Matches(target->label()))
       output->push_back(target);
-    }
   }
 }
 
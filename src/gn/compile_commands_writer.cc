@@ -4,21 +4,33 @@
 
 #include "gn/compile_commands_writer.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
 #include <sstream>
+#include <unordered_map>
 
+#include "base/files/file.h"
+#include "base/files/file_util.h"
 #include "base/json/string_escape.h"
+#include "base/md5.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "base/strings/stringprintf.h"
 #include "gn/builder.h"
 #include "gn/c_substitution_type.h"
 #include "gn/c_tool.h"
+#include "gn/chunk_renderer.h"
 #include "gn/config_values_extractors.h"
 #include "gn/deps_iterator.h"
 #include "gn/escape.h"
+#include "gn/label_pattern_matcher.h"
 #include "gn/ninja_target_command_util.h"
 #include "gn/path_output.h"
 #include "gn/string_output_buffer.h"
 #include "gn/substitution_writer.h"
+#include "last_commit_position.h"
 
 // Structure of JSON output file
 // [
@@ -221,69 +233,326 @@ void WriteCommand(const Target* target,
   }
 }
 
-void OutputJSON(const BuildSettings* build_settings,
-                std::vector<const Target*>& all_targets,
-                std::ostream& out) {
-  out << '[';
-  out << kPrettyPrintLineEnding;
-  bool first = true;
-  auto build_dir = build_settings->GetFullPath(build_settings->build_dir())
-                       .StripTrailingSeparators();
-  std::vector<OutputFile> tool_outputs;  // Prevent reallocation in loop.
+// The compile step of one source file of a target.
+struct SourceCompile {
+  const SourceFile* source;
+  SourceFile::Type source_type;
+  const char* tool_name;
+  std::vector<OutputFile> tool_outputs;
+};
 
-  EscapeOptions opts;
-  opts.mode = ESCAPE_NINJA_PREFORMATTED_COMMAND;
+// The entries of the compilation database for one target.
+struct TargetFragment {
+  // Identifies the target in the fragment index. Only set when writing
+  // incrementally.
+  std::string label;
 
-  for (const auto* target : all_targets) {
-    if (!target->IsBinary())
-      continue;
+  // Fingerprint of everything the entries are computed from. Only set when
+  // writing incrementally.
+  std::string fingerprint;
 
-    // Precompute values that are the same for all sources in a target to avoid
-    // computing for every source.
-
-    PathOutput path_output(
-        target->settings()->build_settings()->build_dir(),
-        target->settings()->build_settings()->root_path_utf8(),
-        ESCAPE_NINJA_COMMAND);
-
-    CompileFlags flags;
-    SetupCompileFlags(target, path_output, opts, flags);
-
-    for (const auto& source : target->sources()) {
-      // If this source is not a C/C++/ObjC/ObjC++ source (not header) file,
-      // continue as it does not belong in the compilation database.
-      const SourceFile::Type source_type = source.GetType();
-      if (source_type != SourceFile::SOURCE_CPP &&
-          source_type != SourceFile::SOURCE_C &&
-          source_type != SourceFile::SOURCE_M &&
-          source_type != SourceFile::SOURCE_MM)
-        continue;
+  // The entries, separated by commas. Only kept until they are appended to
+  // the database.
+  std::string json;
+
+  // The length of |json| once appended.
+  size_t length = 0;
+
+  // Whether the entries were rendered rather than copied from the previous
+  // database.
+  bool rendered = false;
+};
+
+// Index of the per-target fragments of a compilation database written by a
+// previous run. When a target's fingerprint is unchanged, its entries are
+// copied from the previous database instead of being rendered again.
+//
+// The index is stored next to the database. It starts with a format line, the
+// version of GN that wrote it and the size and modification time of the
+// database it describes, followed by one line per target:
+//
+//   <fingerprint> <offset> <length> <label>
+class FragmentIndex {
+ public:
+  FragmentIndex() = default;
+
+  static base::FilePath GetIndexPath(const base::FilePath& database_path) {
+    return database_path.AddExtension(FILE_PATH_LITERAL("index"));
+  }
 
-      const char* tool_name = Tool::kToolNone;
-      if (!target->GetOutputFilesForSource(source, &tool_name, &tool_outputs))
+  // Loads the index of the database at |database_path|. The index is ignored
+  // if it is missing, malformed, or the database was modified since the
+  // index was written.
+  void Load(const base::FilePath& database_path) {
+    std::string contents;
+    if (!base::ReadFileToString(GetIndexPath(database_path), &contents))
+      return;
+
+    std::vector<std::string_view> lines = base::SplitStringPiece(
+        contents, "\n", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    if (lines.size() < 3 || lines[0] != kIndexHeader ||
+        lines[1] != LAST_COMMIT_POSITION ||
+        lines[2] != GetDatabaseStamp(database_path))
+      return;
+
+    std::unordered_map<std::string, Entry> entries;
+    for (size_t i = 3; i < lines.size(); i++) {
+      std::vector<std::string_view> fields = base::SplitStringPiece(
+          lines[i], " ", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+      Entry entry;
+      if (fields.size() < 4 ||
+          !base::StringToInt64(fields[1], &entry.offset) ||
+          !base::StringToSizeT(fields[2], &entry.length))
+        return;
+      entry.fingerprint = std::string(fields[0]);
+
+      // Labels can contain spaces, so the label is the rest of the line.
+      size_t label_offset = fields[3].data() - lines[i].data();
+      entries[std::string(lines[i].substr(label_offset))] = std::move(entry);
+    }
+
+    database_.Initialize(database_path,
+                         base::File::FLAG_OPEN | base::File::FLAG_READ);
+    if (database_.IsValid())
+      entries_ = std::move(entries);
+  }
+
+  // Returns true and sets |json| to the fragment of the previous database
+  // for the given target if it was computed from the same fingerprint. May
+  // be called from multiple threads.
+  bool Lookup(const std::string& label,
+              const std::string& fingerprint,
+              std::string* json) const {
+    auto found = entries_.find(label);
+    if (found == entries_.end() || found->second.fingerprint != fingerprint)
+      return false;
+
+    json->resize(found->second.length);
+    int length = static_cast<int>(found->second.length);
+    return database_.Read(found->second.offset, json->data(), length) ==
+           length;
+  }
+
+  // Closes the previous database so that it can be replaced.
+  void Close() { database_.Close(); }
+
+  // Writes the index for the given fragments, which were written to the
+  // database at |database_path| in order, starting at |first_offset| and
+  // separated by |separator_length| bytes.
+  static bool Write(const base::FilePath& database_path,
+                    const std::vector<TargetFragment>& fragments,
+                    size_t first_offset,
+                    size_t separator_length,
+                    Err* err) {
+    StringOutputBuffer index;
+    index << kIndexHeader << "\n" << LAST_COMMIT_POSITION << "\n"
+          << GetDatabaseStamp(database_path) << "\n";
+    size_t offset = first_offset;
+    for (const TargetFragment& fragment : fragments) {
+      if (fragment.length == 0)
         continue;
+      index << fragment.fingerprint << " " << base::NumberToString(offset)
+            << " " << base::NumberToString(fragment.length) << " "
+            << fragment.label << "\n";
+      offset += fragment.length + separator_length;
+    }
+    return index.WriteToFileIfChanged(GetIndexPath(database_path), err);
+  }
 
-      if (!first) {
-        out << ',';
-        out << kPrettyPrintLineEnding;
-      }
-      first = false;
-      out << "  {";
-      out << kPrettyPrintLineEnding;
+ private:
+  struct Entry {
+    std::string fingerprint;
+    int64_t offset = 0;
+    size_t length = 0;
+  };
+
+  static constexpr char kIndexHeader[] = "gn compile_commands.json index v1";
+
+  // Identifies the current contents of the database.
+  static std::string GetDatabaseStamp(const base::FilePath& database_path) {
+    base::File::Info info;
+    if (!base::GetFileInfo(database_path, &info))
+      return std::string();
+    return base::NumberToString(info.size) + " " +
+           base::NumberToString(info.last_modified);
+  }
+
+  std::unordered_map<std::string, Entry> entries_;
 
-      WriteFile(source, path_output, out);
-      WriteDirectory(base::StringPrintf("%" PRIsFP, PATH_CSTR(build_dir)), out);
-      WriteCommand(target, source, flags, tool_outputs, path_output,
-                   source_type, tool_name, opts, out);
-      out << "\"";
+  // Reads at explicit offsets don't change the state of the file, so they
+  // can be done concurrently from const methods.
+  mutable base::File database_;
+
+  FragmentIndex(const FragmentIndex&) = delete;
+  FragmentIndex& operator=(const FragmentIndex&) = delete;
+};
+
+// Computes a fingerprint of everything the compile commands of a target are
+// computed from: the flags, the tools' command patterns, the sources and their
+// outputs, and the values of the target-dependent substitutions.
+std::string ComputeFingerprint(const Target* target,
+                               const std::string& build_dir,
+                               const CompileFlags& flags,
+                               const std::vector<SourceCompile>& compiles) {
+  base::MD5Context context;
+  base::MD5Init(&context);
+  auto add = [&context](std::string_view str) {
+    base::MD5Update(&context, str);
+    base::MD5Update(&context, std::string_view("\0", 1));
+  };
+
+  add(build_dir);
+  add(target->settings()->build_settings()->root_path_utf8());
+  add(target->label().GetUserVisibleName(true));
+  add(target->GetComputedOutputName());
+  for (const std::string* flag :
+       {&flags.includes, &flags.defines, &flags.cflags, &flags.cflags_c,
+        &flags.cflags_cc, &flags.cflags_objc, &flags.cflags_objcc,
+        &flags.framework_dirs, &flags.frameworks})
+    add(*flag);
+
+  for (const SourceCompile& compile : compiles) {
+    add(compile.source->value());
+    add(compile.tool_name);
+    add(target->toolchain()->GetTool(compile.tool_name)->command().AsString());
+    for (const OutputFile& output : compile.tool_outputs)
+      add(output.value());
+  }
+
+  base::MD5Digest digest;
+  base::MD5Final(&digest, &context);
+  return base::MD5DigestToBase16(digest);
+}
+
+// Computes the entries of the compilation database for a target. If |index|
+// is non-null, the fragment's fingerprint is set and the entries are copied
+// from the previous database when possible.
+void RenderTargetFragment(const Target* target,
+                          const std::string& build_dir,
+                          const FragmentIndex* index,
+                          TargetFragment* fragment) {
+  if (!target->IsBinary())
+    return;
+
+  std::vector<SourceCompile> compiles;
+  for (const auto& source : target->sources()) {
+    // If this source is not a C/C++/ObjC/ObjC++ source (not header) file,
+    // continue as it does not belong in the compilation database.
+    const SourceFile::Type source_type = source.GetType();
+    if (source_type != SourceFile::SOURCE_CPP &&
+        source_type != SourceFile::SOURCE_C &&
+        source_type != SourceFile::SOURCE_M &&
+        source_type != SourceFile::SOURCE_MM)
+      continue;
+
+    SourceCompile compile{&source, source_type, Tool::kToolNone, {}};
+    if (!target->GetOutputFilesForSource(source, &compile.tool_name,
+                                         &compile.tool_outputs))
+      continue;
+    compiles.push_back(std::move(compile));
+  }
+  if (compiles.empty())
+    return;
+
+  // Precompute values that are the same for all sources in a target to avoid
+  // computing for every source.
+
+  PathOutput path_output(target->settings()->build_settings()->build_dir(),
+                         target->settings()->build_settings()->root_path_utf8(),
+                         ESCAPE_NINJA_COMMAND);
+
+  EscapeOptions opts;
+  opts.mode = ESCAPE_NINJA_PREFORMATTED_COMMAND;
+
+  CompileFlags flags;
+  SetupCompileFlags(target, path_output, opts, flags);
+
+  if (index) {
+    fragment->label = target->label().GetUserVisibleName(true);
+    fragment->fingerprint =
+        ComputeFingerprint(target, build_dir, flags, compiles);
+    if (index->Lookup(fragment->label, fragment->fingerprint, &fragment->json))
+      return;
+  }
+
+  std::ostringstream out;
+  bool first = true;
+  for (auto& compile : compiles) {
+    if (!first) {
+      out << ',';
       out << kPrettyPrintLineEnding;
-      out << "  }";
     }
+    first = false;
+    out << "  {";
+    out << kPrettyPrintLineEnding;
+
+    WriteFile(*compile.source, path_output, out);
+    WriteDirectory(build_dir, out);
+    WriteCommand(target, *compile.source, flags, compile.tool_outputs,
+                 path_output, compile.source_type, compile.tool_name, opts,
+                 out);
+    out << "\"";
+    out << kPrettyPrintLineEnding;
+    out << "  }";
   }
+  fragment->json = std::move(out).str();
+  fragment->rendered = true;
+}
 
-  out << kPrettyPrintLineEnding;
-  out << "]";
-  out << kPrettyPrintLineEnding;
+// Writes the compilation database for the given targets to |out|. If |index|
+// is non-null, unchanged targets are copied from the previous database.
+// |fragments| receives the index information of all targets, without their
+// entries.
+void OutputJSON(const BuildSettings* build_settings,
+                const std::vector<const Target*>& all_targets,
+                const FragmentIndex* index,
+                std::vector<TargetFragment>* fragments,
+                StringOutputBuffer* out) {
+  auto build_dir = build_settings->GetFullPath(build_settings->build_dir())
+                       .StripTrailingSeparators();
+  std::string build_dir_str =
+      base::StringPrintf("%" PRIsFP, PATH_CSTR(build_dir));
+
+  out->Append('[');
+  out->Append(kPrettyPrintLineEnding);
+
+  // The fragments of chunks of targets are rendered in parallel, and appended
+  // in order so the output is deterministic. Each fragment is freed once
+  // appended, so only the chunks being rendered are held in memory.
+  constexpr size_t kTargetsPerChunk = 64;
+  fragments->resize(all_targets.size());
+  bool first = true;
+  RenderChunksInOrder(
+      (all_targets.size() + kTargetsPerChunk - 1) / kTargetsPerChunk,
+      [&all_targets, &build_dir_str, index, fragments](size_t chunk) {
+        size_t begin = chunk * kTargetsPerChunk;
+        size_t end = std::min(all_targets.size(), begin + kTargetsPerChunk);
+        for (size_t i = begin; i < end; i++) {
+          RenderTargetFragment(all_targets[i], build_dir_str, index,
+                               &(*fragments)[i]);
+        }
+      },
+      [&all_targets, fragments, out, &first](size_t chunk) {
+        size_t begin = chunk * kTargetsPerChunk;
+        size_t end = std::min(all_targets.size(), begin + kTargetsPerChunk);
+        for (size_t i = begin; i < end; i++) {
+          TargetFragment& fragment = (*fragments)[i];
+          if (fragment.json.empty())
+            continue;
+          if (!first) {
+            out->Append(',');
+            out->Append(kPrettyPrintLineEnding);
+          }
+          first = false;
+          out->Append(fragment.json);
+          fragment.length = fragment.json.size();
+          std::string().swap(fragment.json);
+        }
+      });
+
+  out->Append(kPrettyPrintLineEnding);
+  out->Append(']');
+  out->Append(kPrettyPrintLineEnding);
 }
 
 }  // namespace
@@ -292,8 +561,8 @@ std::string CompileCommandsWriter::RenderJSON(
     const BuildSettings* build_settings,
     std::vector<const Target*>& all_targets) {
   StringOutputBuffer json;
-  std::ostream out(&json);
-  OutputJSON(build_settings, all_targets, out);
+  std::vector<TargetFragment> fragments;
+  OutputJSON(build_settings, all_targets, nullptr, &fragments, &json);
   return json.str();
 }
 
@@ -303,17 +572,35 @@ bool CompileCommandsWriter::RunAndWriteFiles(
     const std::vector<LabelPattern>& patterns,
     const std::optional<std::string>& legacy_target_filters,
     const base::FilePath& output_path,
-    Err* err) {
+    Err* err,
+    size_t* rendered_targets) {
   std::vector<const Target*> to_write = CollectTargets(
       build_settings, all_targets, patterns, legacy_target_filters, err);
   if (err->has_error())
     return false;
 
+  // Reuse the entries of unchanged targets from the previous database.
+  FragmentIndex index;
+  index.Load(output_path);
+
   StringOutputBuffer json;
-  std::ostream output_to_json(&json);
-  OutputJSON(build_settings, to_write, output_to_json);
+  std::vector<TargetFragment> fragments;
+  OutputJSON(build_settings, to_write, &index, &fragments, &json);
+  index.Close();
+  if (rendered_targets) {
+    *rendered_targets = std::count_if(
+        fragments.begin(), fragments.end(),
+        [](const TargetFragment& fragment) { return fragment.rendered; });
+  }
+
+  if (!json.WriteToFileIfChanged(output_path, err))
+    return false;
 
-  return json.WriteToFileIfChanged(output_path, err);
+  // Each fragment is preceded by the opening bracket or a separator, which
+  // are both a character followed by a line ending.
+  const size_t separator_length = 1 + strlen(kPrettyPrintLineEnding);
+  return FragmentIndex::Write(output_path, fragments, separator_length,
+                              separator_length, err);
 }
 
 std::vector<const Target*> CompileCommandsWriter::CollectTargets(
@@ -331,8 +618,9 @@ std::vector<const Target*> CompileCommandsWriter::CollectTargets(
   // Collect the first level of target matches. These are the ones that the
   // patterns match directly.
   std::vector<const Target*> input_targets;
+  LabelPatternMatcher matcher(patterns);
   for (const Target* target : all_targets) {
-    if (LabelPattern::VectorMatches(patterns, target->label()))
+    if (matcher.Matches(target->label()))
       input_targets.push_back(target);
   }
 
@@ -31,13 +31,18 @@ class CompileCommandsWriter {
   //
   // TODO(https://bugs.chromium.org/p/gn/issues/detail?id=302):
   // Remove this legacy target filters behavior.
+  //
+  // If |rendered_targets| is non-null, it receives the number of targets
+  // whose entries were rendered rather than copied from the previous
+  // database.
   static bool RunAndWriteFiles(
       const BuildSettings* build_setting,
       const std::vector<const Target*>& all_targets,
       const std::vector<LabelPattern>& patterns,
       const std::optional<std::string>& legacy_target_filters,
       const base::FilePath& output_path,
-      Err* err);
+      Err* err,
+      size_t* rendered_targets = nullptr);
 
   // Collects all the targets whose commands should get written as part of
   // RunAndWriteFiles() (separated out for unit testing).
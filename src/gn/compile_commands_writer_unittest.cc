@@ -8,6 +8,8 @@
 #include <sstream>
 #include <utility>
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "gn/config.h"
 #include "gn/ninja_target_command_util.h"
 #include "gn/scheduler.h"
@@ -734,3 +736,65 @@ TEST_F(CompileCommandsTest, CollectTargets) {
   EXPECT_EQ(&target2, output[3]);
   EXPECT_EQ(&icu_target, output[4]);
 }
+
+TEST_F(CompileCommandsTest, IncrementalWrite) {
+  Err err;
+  std::vector<const Target*> targets;
+
+  Target target1(settings(), Label(SourceDir("//foo/"), "bar1"));
+  target1.set_output_type(Target::SOURCE_SET);
+  target1.sources().push_back(SourceFile("//foo/input1.cc"));
+  target1.sources().push_back(SourceFile("//foo/input2.cc"));
+  target1.SetToolchain(toolchain());
+  ASSERT_TRUE(target1.OnResolved(&err));
+  targets.push_back(&target1);
+
+  Target target2(settings(), Label(SourceDir("//foo/"), "bar2"));
+  target2.set_output_type(Target::SOURCE_SET);
+  target2.sources().push_back(SourceFile("//foo/input3.cc"));
+  target2.SetToolchain(toolchain());
+  ASSERT_TRUE(target2.OnResolved(&err));
+  targets.push_back(&target2);
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath output_path =
+      temp_dir.GetPath().AppendASCII("compile_commands.json");
+
+  // The empty legacy filter writes all targets in order.
+  size_t rendered = 0;
+  auto write_and_read = [&]() {
+    EXPECT_TRUE(CompileCommandsWriter::RunAndWriteFiles(
+        build_settings(), targets, std::vector<LabelPattern>(), std::string(),
+        output_path, &err, &rendered));
+    std::string contents;
+    EXPECT_TRUE(base::ReadFileToString(output_path, &contents));
+    return contents;
+  };
+
+  // The first write has no index to reuse, and writes one.
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), targets),
+            write_and_read());
+  EXPECT_EQ(2u, rendered);
+  EXPECT_TRUE(base::PathExists(
+      temp_dir.GetPath().AppendASCII("compile_commands.json.index")));
+
+  // Unchanged targets are reassembled from the previous database.
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), targets),
+            write_and_read());
+  EXPECT_EQ(0u, rendered);
+
+  // Changing the flags of one target only changes its entries.
+  target2.config_values().cflags().push_back("-DCHANGED");
+  std::string changed = write_and_read();
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), targets),
+            changed);
+  EXPECT_NE(std::string::npos, changed.find("-DCHANGED"));
+  EXPECT_EQ(1u, rendered);
+
+  // Removing a target also updates the database.
+  targets.erase(targets.begin());
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), targets),
+            write_and_read());
+  EXPECT_EQ(0u, rendered);
+}
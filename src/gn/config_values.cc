@@ -20,6 +20,20 @@ ConfigValues::ConfigValues() = default;
 
 ConfigValues::~ConfigValues() = default;
 
+ConfigValues::EscapedStringsCache::EscapedStringsCache() = default;
+
+ConfigValues::EscapedStringsCache::EscapedStringsCache(
+    const EscapedStringsCache&) {}
+
+ConfigValues::EscapedStringsCache::~EscapedStringsCache() = default;
+
+ConfigValues::EscapedStringsCache&
+ConfigValues::EscapedStringsCache::operator=(const EscapedStringsCache&) {
+  std::lock_guard<std::mutex> guard(lock);
+  entries.clear();
+  return *this;
+}
+
 void ConfigValues::AppendValues(const ConfigValues& append) {
   VectorAppend(&asmflags_, append.asmflags_);
   VectorAppend(&arflags_, append.arflags_);
@@ -50,3 +64,27 @@ void ConfigValues::AppendValues(const ConfigValues& append) {
   if (!append.precompiled_source_.is_null() && !precompiled_source_.is_null())
     precompiled_source_ = append.precompiled_source_;
 }
+
+const std::string& ConfigValues::GetEscapedStrings(
+    const std::vector<std::string>& (ConfigValues::*getter)() const,
+    const EscapeOptions& options) const {
+  const std::vector<std::string>* list = &(this->*getter)();
+
+  std::lock_guard<std::mutex> guard(escaped_strings_.lock);
+  for (const auto& entry : escaped_strings_.entries) {
+    if (entry->list == list && entry->options.mode == options.mode &&
+        entry->options.platform == options.platform &&
+        entry->options.inhibit_quoting == options.inhibit_quoting)
+      return entry->escaped;
+  }
+
+  auto entry = std::make_unique<EscapedStringsCache::Entry>();
+  entry->list = list;
+  entry->options = options;
+  for (const std::string& value : *list) {
+    entry->escaped.push_back(' ');
+    entry->escaped.append(EscapeString(value, options, nullptr));
+  }
+  escaped_strings_.entries.push_back(std::move(entry));
+  return escaped_strings_.entries.back()->escaped;
+}
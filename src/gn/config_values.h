@@ -5,9 +5,12 @@
 #ifndef TOOLS_GN_CONFIG_VALUES_H_
 #define TOOLS_GN_CONFIG_VALUES_H_
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "gn/escape.h"
 #include "gn/lib_file.h"
 #include "gn/source_dir.h"
 #include "gn/source_file.h"
@@ -69,6 +72,15 @@ class ConfigValues {
   }
   std::vector<std::pair<std::string, LibFile>>& externs() { return externs_; }
 
+  // Returns the values of the given string list getter escaped with the given
+  // options, each one preceded by a space, ready to be written to a ninja
+  // file. The result is computed on first use and then cached per list and
+  // escaping options, so that flags of a config shared by many targets are
+  // only escaped once. Only call this once the values are final. Thread-safe.
+  const std::string& GetEscapedStrings(
+      const std::vector<std::string>& (ConfigValues::*getter)() const,
+      const EscapeOptions& options) const;
+
   bool has_precompiled_headers() const {
     return !precompiled_header_.empty() || !precompiled_source_.is_null();
   }
@@ -102,6 +114,27 @@ class ConfigValues {
 
   std::string precompiled_header_;
   SourceFile precompiled_source_;
+
+  // Backing store of GetEscapedStrings(). Copying a ConfigValues does not
+  // copy the cache since the copy is usually modified right after.
+  class EscapedStringsCache {
+   public:
+    EscapedStringsCache();
+    EscapedStringsCache(const EscapedStringsCache&);
+    ~EscapedStringsCache();
+
+    EscapedStringsCache& operator=(const EscapedStringsCache&);
+
+    struct Entry {
+      const std::vector<std::string>* list;
+      EscapeOptions options;
+      std::string escaped;
+    };
+
+    std::mutex lock;
+    std::vector<std::unique_ptr<Entry>> entries;
+  };
+  mutable EscapedStringsCache escaped_strings_;
 };
 
 #endif  // TOOLS_GN_CONFIG_VALUES_H_
@@ -30,6 +30,22 @@ void RecursiveTargetConfigStringsToStream(
     const std::vector<std::string>& (ConfigValues::*getter)() const,
     const EscapeOptions& escape_options,
     std::ostream& out) {
-  RecursiveTargetConfigToStream(config, target, getter,
-                                EscapedStringWriter(escape_options), out);
+  if (config == kRecursiveWriterSkipDuplicates) {
+    RecursiveTargetConfigToStream(config, target, getter,
+                                  EscapedStringWriter(escape_options), out);
+    return;
+  }
+
+  // Configs are typically shared by many targets, so write their values from
+  // the pre-escaped cache. The target's own values are only written for this
+  // target and are escaped directly.
+  EscapedStringWriter writer(escape_options);
+  for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
+    if (iter.GetCurrentConfig()) {
+      out << iter.cur().GetEscapedStrings(getter, escape_options);
+    } else {
+      for (const std::string& value : (iter.cur().*getter)())
+        writer(value, out);
+    }
+  }
 }
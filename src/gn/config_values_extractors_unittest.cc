@@ -6,6 +6,7 @@
 
 #include "gn/config.h"
 #include "gn/config_values_extractors.h"
+#include "gn/escape.h"
 #include "gn/target.h"
 #include "gn/test_with_scope.h"
 #include "util/test/test.h"
@@ -147,3 +148,48 @@ TEST(ConfigValuesExtractors, IncludeOrdering) {
             "//target/ //target/config/ //target/all/ //target/direct/ "
             "//dep1/all/ //dep2/all/ //dep1/direct/ ");
 }
+
+TEST(ConfigValuesExtractors, EscapedStrings) {
+  TestWithScope setup;
+  Err err;
+
+  Config config(setup.settings(), Label(SourceDir("//foo/"), "config"));
+  config.visibility().SetPublic();
+  config.own_values().cflags().push_back("-DFOO=\"a b\"");
+  config.own_values().cflags().push_back("$bar");
+  ASSERT_TRUE(config.OnResolved(&err));
+
+  Target target(setup.settings(), Label(SourceDir("//foo/"), "target"));
+  target.set_output_type(Target::SOURCE_SET);
+  target.SetToolchain(setup.toolchain());
+  target.configs().push_back(LabelConfigPair(&config));
+  target.config_values().cflags().push_back("a b");
+  ASSERT_TRUE(target.OnResolved(&err));
+
+  EscapeOptions opts;
+  opts.mode = ESCAPE_NINJA_COMMAND;
+  std::ostringstream out;
+  RecursiveTargetConfigStringsToStream(kRecursiveWriterKeepDuplicates,
+                                       &target, &ConfigValues::cflags, opts,
+                                       out);
+  EXPECT_EQ(" " + EscapeString("a b", opts, nullptr) + " " +
+                EscapeString("-DFOO=\"a b\"", opts, nullptr) + " " +
+                EscapeString("$bar", opts, nullptr),
+            out.str());
+
+  // The escaped config values are computed once and reused afterwards.
+  const std::string& escaped =
+      config.resolved_values().GetEscapedStrings(&ConfigValues::cflags, opts);
+  EXPECT_EQ(&escaped, &config.resolved_values().GetEscapedStrings(
+                          &ConfigValues::cflags, opts));
+  std::ostringstream out2;
+  RecursiveTargetConfigStringsToStream(kRecursiveWriterKeepDuplicates,
+                                       &target, &ConfigValues::cflags, opts,
+                                       out2);
+  EXPECT_EQ(out.str(), out2.str());
+
+  // Other escaping modes get their own entry.
+  EscapeOptions none_opts;
+  EXPECT_EQ(" -DFOO=\"a b\" $bar", config.resolved_values().GetEscapedStrings(
+                                         &ConfigValues::cflags, none_opts));
+}
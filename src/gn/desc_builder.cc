@@ -2,10 +2,14 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <set>
+#include <string_view>
 
 #include "base/json/json_writer.h"
+#include "base/json/string_escape.h"
 #include "base/strings/string_number_conversions.h"
 #include "gn/commands.h"
 #include "gn/config.h"
@@ -20,9 +24,11 @@
 #include "gn/scope.h"
 #include "gn/settings.h"
 #include "gn/standard_out.h"
+#include "gn/string_output_buffer.h"
 #include "gn/substitution_writer.h"
 #include "gn/swift_variables.h"
 #include "gn/variables.h"
+#include "util/build_config.h"
 
 // Example structure of Value for single target
 // (not applicable or empty fields will be omitted depending on target type)
@@ -316,11 +322,14 @@ class ConfigDescBuilder : public BaseDescBuilder {
 class TargetDescBuilder : public BaseDescBuilder {
  public:
   TargetDescBuilder(const Target* target,
+                    const ResolvedTargetData& resolved,
                     const std::set<std::string>& what,
                     bool all,
                     bool tree,
                     bool blame)
-      : BaseDescBuilder(what, all, tree, blame), target_(target) {}
+      : BaseDescBuilder(what, all, tree, blame),
+        target_(target),
+        resolved_(resolved) {}
 
   std::unique_ptr<base::DictionaryValue> BuildDescription() {
     auto res = std::make_unique<base::DictionaryValue>();
@@ -584,12 +593,10 @@ class TargetDescBuilder : public BaseDescBuilder {
     // currently implement a blame feature for this since the bottom-up
     // inheritance makes this difficult.
 
-    ResolvedTargetData resolved;
-
     // Libs can be part of any target and get recursively pushed up the chain,
     // so display them regardless of target type.
     if (what(variables::kLibs)) {
-      const auto& all_libs = resolved.GetLinkedLibraries(target_);
+      const auto& all_libs = resolved_.GetLinkedLibraries(target_);
       if (!all_libs.empty()) {
         auto libs = std::make_unique<base::ListValue>();
         for (size_t i = 0; i < all_libs.size(); i++)
@@ -599,7 +606,7 @@ class TargetDescBuilder : public BaseDescBuilder {
     }
 
     if (what(variables::kLibDirs)) {
-      const auto& all_lib_dirs = resolved.GetLinkedLibraryDirs(target_);
+      const auto& all_lib_dirs = resolved_.GetLinkedLibraryDirs(target_);
       if (!all_lib_dirs.empty()) {
         auto lib_dirs = std::make_unique<base::ListValue>();
         for (size_t i = 0; i < all_lib_dirs.size(); i++)
@@ -609,7 +616,7 @@ class TargetDescBuilder : public BaseDescBuilder {
     }
 
     if (what(variables::kFrameworks)) {
-      const auto& all_frameworks = resolved.GetLinkedFrameworks(target_);
+      const auto& all_frameworks = resolved_.GetLinkedFrameworks(target_);
       if (!all_frameworks.empty()) {
         auto frameworks = std::make_unique<base::ListValue>();
         for (size_t i = 0; i < all_frameworks.size(); i++)
@@ -619,7 +626,7 @@ class TargetDescBuilder : public BaseDescBuilder {
       }
     }
     if (what(variables::kWeakFrameworks)) {
-      const auto& weak_frameworks = resolved.GetLinkedWeakFrameworks(target_);
+      const auto& weak_frameworks = resolved_.GetLinkedWeakFrameworks(target_);
       if (!weak_frameworks.empty()) {
         auto frameworks = std::make_unique<base::ListValue>();
         for (size_t i = 0; i < weak_frameworks.size(); i++)
@@ -630,7 +637,7 @@ class TargetDescBuilder : public BaseDescBuilder {
     }
 
     if (what(variables::kFrameworkDirs)) {
-      const auto& all_framework_dirs = resolved.GetLinkedFrameworkDirs(target_);
+      const auto& all_framework_dirs = resolved_.GetLinkedFrameworkDirs(target_);
       if (!all_framework_dirs.empty()) {
         auto framework_dirs = std::make_unique<base::ListValue>();
         for (size_t i = 0; i < all_framework_dirs.size(); i++)
@@ -912,12 +919,556 @@ class TargetDescBuilder : public BaseDescBuilder {
   }
 
   const Target* target_;
+  const ResolvedTargetData& resolved_;
+};
+
+#if defined(OS_WIN)
+const char kLineEnding[] = "\r\n";
+#else
+const char kLineEnding[] = "\n";
+#endif
+
+// Writes the JSON that base::JSONWriter produces with pretty printing for the
+// description built by TargetDescBuilder with no "what", "all", "tree" or
+// "blame", merged with the "source_outputs" description. This is what the
+// JSON project writer outputs for each target. The values are rendered
+// directly as text, and the keys of each dictionary are sorted as in a
+// base::DictionaryValue.
+//
+// |depth| is the nesting level of the target's dictionary, which indents
+// every line after the first by 3 spaces per level.
+class TargetJSONWriter {
+ public:
+  TargetJSONWriter(const Target* target,
+                   const ResolvedTargetData& resolved,
+                   size_t depth)
+      : target_(target), resolved_(resolved), depth_(depth) {}
+
+  void Write(StringOutputBuffer& out) {
+    const size_t value_depth = depth_ + 1;
+    bool is_binary_output = target_->IsBinary();
+
+    AppendString(Target::GetStringForOutputType(target_->output_type()),
+                 AddField("type"));
+    AppendString(
+        target_->label().GetToolchainLabel().GetUserVisibleName(false),
+        AddField("toolchain"));
+
+    if (target_->source_types_used().RustSourceUsed()) {
+      AppendSourceFile(target_->rust_values().crate_root(),
+                       AddField(variables::kRustCrateRoot));
+      AppendString(target_->rust_values().crate_name(),
+                   AddField(variables::kRustCrateName));
+    }
+
+    if (target_->source_types_used().SwiftSourceUsed()) {
+      AppendSourceFile(target_->swift_values().bridge_header(),
+                       AddField(variables::kSwiftBridgeHeader));
+      AppendString(target_->swift_values().module_name(),
+                   AddField(variables::kSwiftModuleName));
+    }
+
+    AppendScopeValues(target_->metadata().contents(), value_depth,
+                      AddField(variables::kMetadata));
+
+    AppendList(target_->visibility().patterns(),
+               [](const LabelPattern& pattern, std::string* out) {
+                 AppendString(pattern.Describe(), out);
+               },
+               AddField(variables::kVisibility));
+
+    AppendBool(target_->testonly(), AddField(variables::kTestonly));
+
+    if (is_binary_output) {
+      AppendBool(target_->check_includes(),
+                 AddField(variables::kCheckIncludes));
+      AppendList(target_->allow_circular_includes_from(),
+                 [this](const Label& label, std::string* out) {
+                   AppendString(label.GetUserVisibleName(GetToolchainLabel()),
+                                out);
+                 },
+                 AddField(variables::kAllowCircularIncludesFrom));
+    }
+
+    if (!target_->sources().empty())
+      AppendSourceFiles(target_->sources(), AddField(variables::kSources));
+
+    if (!target_->output_name().empty())
+      AppendString(target_->output_name(), AddField(variables::kOutputName));
+
+    if (!target_->output_dir().is_null())
+      AppendSourceDir(target_->output_dir(), AddField(variables::kOutputDir));
+
+    if (target_->output_extension_set()) {
+      AppendString(target_->output_extension(),
+                   AddField(variables::kOutputExtension));
+    }
+
+    if (target_->all_headers_public()) {
+      AppendString("*", AddField(variables::kPublic));
+    } else {
+      AppendSourceFiles(target_->public_headers(),
+                        AddField(variables::kPublic));
+    }
+
+    // Binary targets list their inputs again with the other config values
+    // below, with the same result.
+    std::vector<const SourceFile*> inputs;
+    for (ConfigValuesIterator iter(target_); !iter.done(); iter.Next()) {
+      for (const auto& input : iter.cur().inputs())
+        inputs.push_back(&input);
+    }
+    if (!inputs.empty()) {
+      AppendList(inputs,
+                 [](const SourceFile* file, std::string* out) {
+                   AppendSourceFile(*file, out);
+                 },
+                 AddField(variables::kInputs));
+    }
+
+    if (is_binary_output && !target_->configs().empty())
+      AppendConfigs(target_->configs().vector(), AddField(variables::kConfigs));
+    if (!target_->public_configs().empty()) {
+      AppendConfigs(target_->public_configs(),
+                    AddField(variables::kPublicConfigs));
+    }
+    if (!target_->all_dependent_configs().empty()) {
+      AppendConfigs(target_->all_dependent_configs(),
+                    AddField(variables::kAllDependentConfigs));
+    }
+
+    if (target_->output_type() == Target::ACTION ||
+        target_->output_type() == Target::ACTION_FOREACH) {
+      const ActionValues& action_values = target_->action_values();
+      AppendString(action_values.script().value(),
+                   AddField(variables::kScript));
+      AppendSubstitutionList(action_values.args(), AddField(variables::kArgs));
+      if (!action_values.rsp_file_contents().list().empty()) {
+        AppendSubstitutionList(action_values.rsp_file_contents(),
+                               AddField(variables::kResponseFileContents));
+      }
+      if (!action_values.depfile().empty()) {
+        AppendString(action_values.depfile().AsString(),
+                     AddField(variables::kDepfile));
+      }
+    }
+
+    if (target_->output_type() != Target::SOURCE_SET &&
+        target_->output_type() != Target::GROUP &&
+        target_->output_type() != Target::BUNDLE_DATA) {
+      WriteOutputs();
+    }
+
+    WriteSourceOutputs(value_depth);
+
+    if (target_->output_type() == Target::CREATE_BUNDLE)
+      WriteBundle(value_depth);
+
+    if (is_binary_output)
+      WriteConfigValues(value_depth);
+
+    if (target_->output_type() == Target::GENERATED_FILE) {
+      AppendValue(target_->output_conversion(), value_depth,
+                  AddField(variables::kWriteOutputConversion));
+      AppendStrings(target_->data_keys(), AddField(variables::kDataKeys));
+      AppendSourceDir(target_->rebase(), AddField(variables::kRebase));
+      AppendStrings(target_->walk_keys(), AddField(variables::kWalkKeys));
+    }
+
+    WriteDeps();
+
+    if (!target_->gen_deps().empty()) {
+      Label default_tc = target_->settings()->default_toolchain_label();
+      std::vector<std::string> gen_deps;
+      for (const auto& pair : target_->gen_deps())
+        gen_deps.push_back(pair.label.GetUserVisibleName(default_tc));
+      std::sort(gen_deps.begin(), gen_deps.end());
+      AppendStrings(gen_deps, AddField(variables::kGenDeps));
+    }
+
+    const auto& libs = resolved_.GetLinkedLibraries(target_);
+    if (!libs.empty()) {
+      AppendList(libs,
+                 [](const LibFile& lib, std::string* out) {
+                   AppendString(lib.value(), out);
+                 },
+                 AddField(variables::kLibs));
+    }
+    const auto& lib_dirs = resolved_.GetLinkedLibraryDirs(target_);
+    if (!lib_dirs.empty())
+      AppendSourceDirs(lib_dirs, AddField(variables::kLibDirs));
+    const auto& frameworks = resolved_.GetLinkedFrameworks(target_);
+    if (!frameworks.empty())
+      AppendStrings(frameworks, AddField(variables::kFrameworks));
+    const auto& weak_frameworks = resolved_.GetLinkedWeakFrameworks(target_);
+    if (!weak_frameworks.empty())
+      AppendStrings(weak_frameworks, AddField(variables::kWeakFrameworks));
+    const auto& framework_dirs = resolved_.GetLinkedFrameworkDirs(target_);
+    if (!framework_dirs.empty()) {
+      AppendList(framework_dirs,
+                 [](const SourceDir& dir, std::string* out) {
+                   AppendString(dir.value(), out);
+                 },
+                 AddField(variables::kFrameworkDirs));
+    }
+
+    std::sort(fields_.begin(), fields_.end(),
+              [](const Field& a, const Field& b) { return a.first < b.first; });
+    std::string dict;
+    AppendDict(fields_, depth_, &dict);
+    out.Append(dict);
+  }
+
+ private:
+  // A key and its rendered value.
+  using Field = std::pair<std::string_view, std::string>;
+
+  // Adds a key to the target's dictionary, returning the string its value
+  // must be rendered to.
+  std::string* AddField(std::string_view key) {
+    fields_.emplace_back(key, std::string());
+    return &fields_.back().second;
+  }
+
+  static void AppendString(std::string_view str, std::string* out) {
+    base::EscapeJSONString(str, true, out);
+  }
+
+  static void AppendBool(bool value, std::string* out) {
+    out->append(value ? "true" : "false");
+  }
+
+  static void AppendSourceFile(const SourceFile& file, std::string* out) {
+    if (file.is_null())
+      out->append("null");
+    else
+      AppendString(file.value(), out);
+  }
+
+  static void AppendSourceDir(const SourceDir& dir, std::string* out) {
+    if (dir.is_null())
+      out->append("null");
+    else
+      AppendString(FormatSourceDir(dir), out);
+  }
+
+  template <typename T, typename AppendItem>
+  static void AppendList(const T& items,
+                         AppendItem append_item,
+                         std::string* out) {
+    out->append("[ ");
+    bool first = true;
+    for (const auto& item : items) {
+      if (!first)
+        out->append(", ");
+      first = false;
+      append_item(item, out);
+    }
+    out->append(" ]");
+  }
+
+  static void AppendStrings(const std::vector<std::string>& strings,
+                            std::string* out) {
+    AppendList(strings, &AppendString, out);
+  }
+
+  static void AppendSourceFiles(const std::vector<SourceFile>& files,
+                                std::string* out) {
+    AppendList(files, &AppendSourceFile, out);
+  }
+
+  static void AppendSourceDirs(const std::vector<SourceDir>& dirs,
+                               std::string* out) {
+    AppendList(dirs, &AppendSourceDir, out);
+  }
+
+  static void AppendSubstitutionList(const SubstitutionList& list,
+                                     std::string* out) {
+    AppendList(list.list(),
+               [](const SubstitutionPattern& pattern, std::string* out) {
+                 AppendString(pattern.AsString(), out);
+               },
+               out);
+  }
+
+  // Appends a dictionary at |depth| with the given entries, which must be
+  // sorted by key.
+  static void AppendDict(const std::vector<Field>& entries,
+                         size_t depth,
+                         std::string* out) {
+    out->push_back('{');
+    out->append(kLineEnding);
+    bool first = true;
+    for (const Field& entry : entries) {
+      if (!first) {
+        out->push_back(',');
+        out->append(kLineEnding);
+      }
+      first = false;
+      out->append((depth + 1) * 3, ' ');
+      AppendString(entry.first, out);
+      out->append(": ");
+      out->append(entry.second);
+    }
+    out->append(kLineEnding);
+    out->append(depth * 3, ' ');
+    out->push_back('}');
+  }
+
+  // Appends a GN value at |depth|, as BaseDescBuilder::ToBaseValue() converts
+  // it.
+  static void AppendValue(const Value& value, size_t depth, std::string* out) {
+    switch (value.type()) {
+      case Value::STRING:
+        AppendString(value.string_value(), out);
+        return;
+      case Value::INTEGER:
+        out->append(base::IntToString(int(value.int_value())));
+        return;
+      case Value::BOOLEAN:
+        AppendBool(value.boolean_value(), out);
+        return;
+      case Value::SCOPE: {
+        Scope::KeyValueMap map;
+        value.scope_value()->GetCurrentScopeValues(&map);
+        AppendScopeValues(map, depth, out);
+        return;
+      }
+      case Value::LIST:
+        AppendList(value.list_value(),
+                   [depth](const Value& item, std::string* out) {
+                     AppendValue(item, depth, out);
+                   },
+                   out);
+        return;
+      case Value::NONE:
+        out->append("null");
+        return;
+    }
+    NOTREACHED();
+  }
+
+  // The map is sorted by key already.
+  static void AppendScopeValues(const Scope::KeyValueMap& map,
+                                size_t depth,
+                                std::string* out) {
+    std::vector<Field> entries;
+    entries.reserve(map.size());
+    for (const auto& pair : map) {
+      std::string value;
+      AppendValue(pair.second, depth + 1, &value);
+      entries.emplace_back(pair.first, std::move(value));
+    }
+    AppendDict(entries, depth, out);
+  }
+
+  template <class VectorType>
+  void AppendConfigs(const VectorType& configs, std::string* out) {
+    AppendList(configs,
+               [this](const LabelConfigPair& config, std::string* out) {
+                 AppendString(
+                     config.label.GetUserVisibleName(GetToolchainLabel()), out);
+               },
+               out);
+  }
+
+  // See TargetDescBuilder::FillInOutputs().
+  void WriteOutputs() {
+    std::vector<SourceFile> output_files;
+    Err err;
+    if (!target_->GetOutputsAsSourceFiles(LocationRange(), true, &output_files,
+                                          &err)) {
+      err.PrintToStdout();
+      return;
+    }
+    AppendSourceFiles(output_files, AddField(variables::kOutputs));
+
+    if (target_->output_type() == Target::ACTION_FOREACH ||
+        target_->output_type() == Target::COPY_FILES) {
+      const SubstitutionList& outputs = target_->action_values().outputs();
+      if (!outputs.required_types().empty())
+        AppendSubstitutionList(outputs, AddField("output_patterns"));
+    }
+  }
+
+  // See TargetDescBuilder::FillInSourceOutputs(). The JSON project writer
+  // only adds the dictionary when it is not empty.
+  void WriteSourceOutputs(size_t depth) {
+    if (target_->output_type() != Target::ACTION_FOREACH &&
+        target_->output_type() != Target::COPY_FILES && !target_->IsBinary())
+      return;
+    if (target_->output_type() == Target::COPY_FILES &&
+        target_->action_values().outputs().required_types().empty())
+      return;
+
+    // Repeated sources keep the outputs of their last occurrence.
+    std::map<std::string_view, std::string> source_outputs;
+    for (const auto& source : target_->sources()) {
+      std::vector<OutputFile> outputs;
+      const char* tool_name = Tool::kToolNone;
+      if (target_->GetOutputFilesForSource(source, &tool_name, &outputs)) {
+        std::string& list = source_outputs[source.value()];
+        list.clear();
+        AppendList(outputs,
+                   [](const OutputFile& output, std::string* out) {
+                     AppendString(output.value(), out);
+                   },
+                   &list);
+      }
+    }
+    if (source_outputs.empty())
+      return;
+    std::vector<Field> entries(source_outputs.begin(), source_outputs.end());
+    AppendDict(entries, depth, AddField("source_outputs"));
+  }
+
+  // See TargetDescBuilder::FillInBundle().
+  void WriteBundle(size_t depth) {
+    const BundleData& bundle_data = target_->bundle_data();
+    std::vector<Field> entries;
+    auto add_entry = [&entries](std::string_view key) {
+      entries.emplace_back(key, std::string());
+      return &entries.back().second;
+    };
+
+    AppendList(bundle_data.bundle_deps(),
+               [this](const Target* dep, std::string* out) {
+                 AppendString(
+                     dep->label().GetUserVisibleName(GetToolchainLabel()), out);
+               },
+               add_entry("deps"));
+    AppendSourceDir(bundle_data.executable_dir(), add_entry("executable_dir"));
+    AppendSourceFile(bundle_data.partial_info_plist(),
+                     add_entry("partial_info_plist"));
+    AppendString(bundle_data.product_type(), add_entry("product_type"));
+    AppendSourceDir(bundle_data.resources_dir(), add_entry("resources_dir"));
+    AppendSourceDir(bundle_data.root_dir(), add_entry("root_dir"));
+    AppendString(
+        bundle_data.GetBundleRootDirOutput(target_->settings()).value(),
+        add_entry("root_dir_output"));
+    BundleData::SourceFiles sources;
+    bundle_data.GetSourceFiles(&sources);
+    AppendSourceFiles(sources, add_entry("source_files"));
+
+    AppendDict(entries, depth, AddField("bundle_data"));
+  }
+
+  // Appends the values of a config variable from the target and its configs,
+  // if there are any. See TargetDescBuilder::RenderConfigValues().
+  template <class T>
+  void AppendConfigValues(std::string_view name,
+                          RecursiveWriterConfig writer_config,
+                          const std::vector<T>& (ConfigValues::*getter)()
+                              const,
+                          void (*append_value)(const T&, std::string*)) {
+    std::set<T> seen;
+    std::string list;
+    for (ConfigValuesIterator iter(target_); !iter.done(); iter.Next()) {
+      for (const T& val : (iter.cur().*getter)()) {
+        if (writer_config == kRecursiveWriterSkipDuplicates &&
+            !seen.insert(val).second)
+          continue;
+        list.append(list.empty() ? "[ " : ", ");
+        append_value(val, &list);
+      }
+    }
+    if (list.empty())
+      return;
+    list.append(" ]");
+    *AddField(name) = std::move(list);
+  }
+
+  // The config values listed for binary targets.
+  void WriteConfigValues(size_t depth) {
+#define CONFIG_VALUE_ARRAY_HANDLER(name, type, config, append) \
+  AppendConfigValues<type>(#name, config, &ConfigValues::name, append);
+    CONFIG_VALUE_ARRAY_HANDLER(arflags, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(asmflags, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(cflags, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(cflags_c, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(cflags_cc, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(cflags_objc, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(cflags_objcc, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(rustflags, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(rustenv, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(defines, std::string,
+                               kRecursiveWriterSkipDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(include_dirs, SourceDir,
+                               kRecursiveWriterSkipDuplicates, &AppendSourceDir)
+    // inputs were already added above.
+    CONFIG_VALUE_ARRAY_HANDLER(ldflags, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+    CONFIG_VALUE_ARRAY_HANDLER(swiftflags, std::string,
+                               kRecursiveWriterKeepDuplicates, &AppendStringRef)
+#undef CONFIG_VALUE_ARRAY_HANDLER
+
+    // Later externs with the same name replace earlier ones.
+    std::map<std::string_view, std::string> externs;
+    for (ConfigValuesIterator iter(target_); !iter.done(); iter.Next()) {
+      for (const auto& e : iter.cur().externs()) {
+        std::string& value = externs[e.first];
+        value.clear();
+        AppendString(e.second.value(), &value);
+      }
+    }
+    std::vector<Field> entries(externs.begin(), externs.end());
+    AppendDict(entries, depth, AddField(variables::kExterns));
+
+    const ConfigValues& values = target_->config_values();
+    if (!values.precompiled_header().empty()) {
+      AppendString(values.precompiled_header(),
+                   AddField(variables::kPrecompiledHeader));
+    }
+    if (!values.precompiled_source().is_null()) {
+      AppendSourceFile(values.precompiled_source(),
+                       AddField(variables::kPrecompiledSource));
+    }
+  }
+
+  static void AppendStringRef(const std::string& str, std::string* out) {
+    AppendString(str, out);
+  }
+
+  // See TargetDescBuilder::RenderDeps(), the direct dependencies are printed
+  // according to the command line switches.
+  void WriteDeps() {
+    std::vector<const Target*> deps;
+    for (const auto& pair : target_->GetDeps(Target::DEPS_ALL))
+      deps.push_back(pair.ptr);
+    std::sort(deps.begin(), deps.end());
+    base::ListValue printed;
+    commands::FilterAndPrintTargets(&deps, &printed);
+    AppendList(printed,
+               [](const base::Value& value, std::string* out) {
+                 AppendString(value.GetString(), out);
+               },
+               AddField(variables::kDeps));
+  }
+
+  Label GetToolchainLabel() const {
+    return target_->label().GetToolchainLabel();
+  }
+
+  const Target* target_;
+  const ResolvedTargetData& resolved_;
+  size_t depth_;
+  std::vector<Field> fields_;
 };
 
 }  // namespace
 
 std::unique_ptr<base::DictionaryValue> DescBuilder::DescriptionForTarget(
     const Target* target,
+    const ResolvedTargetData& resolved,
     const std::string& what,
     bool all,
     bool tree,
@@ -925,7 +1476,7 @@ std::unique_ptr<base::DictionaryValue> DescBuilder::DescriptionForTarget(
   std::set<std::string> w;
   if (!what.empty())
     w.insert(what);
-  TargetDescBuilder b(target, w, all, tree, blame);
+  TargetDescBuilder b(target, resolved, w, all, tree, blame);
   return b.BuildDescription();
 }
 
@@ -938,3 +1489,11 @@ std::unique_ptr<base::DictionaryValue> DescBuilder::DescriptionForConfig(
   ConfigDescBuilder b(config, w);
   return b.BuildDescription();
 }
+
+// static
+void DescBuilder::WriteTargetJSON(const Target* target,
+                                  const ResolvedTargetData& resolved,
+                                  size_t depth,
+                                  StringOutputBuffer& out) {
+  TargetJSONWriter(target, resolved, depth).Write(out);
+}
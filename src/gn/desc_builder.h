@@ -5,19 +5,39 @@
 #ifndef TOOLS_GN_DESC_BUILDER_H_
 #define TOOLS_GN_DESC_BUILDER_H_
 
+#include <stddef.h>
+
 #include "base/values.h"
 #include "gn/target.h"
 
+class ResolvedTargetData;
+class StringOutputBuffer;
+
 class DescBuilder {
  public:
-  // Creates Dictionary representation for given target
+  // Creates Dictionary representation for given target. |resolved| caches
+  // the inherited values (libs, frameworks...) and can be shared between the
+  // descriptions of several targets.
   static std::unique_ptr<base::DictionaryValue> DescriptionForTarget(
       const Target* target,
+      const ResolvedTargetData& resolved,
       const std::string& what,
       bool all,
       bool tree,
       bool blame);
 
+  // Writes the JSON of DescriptionForTarget(target, resolved, "", false, false,
+  // false)
+  // merged with its "source_outputs", as base::JSONWriter formats it with
+  // pretty printing but without the final line ending. Lines after the first
+  // are indented for a dictionary nested |depth| levels deep. This is what
+  // the JSON project writer outputs for each target; it is rendered directly,
+  // without building the base::Value tree.
+  static void WriteTargetJSON(const Target* target,
+                              const ResolvedTargetData& resolved,
+                              size_t depth,
+                              StringOutputBuffer& out);
+
   // Creates Dictionary representation for given config
   static std::unique_ptr<base::DictionaryValue> DescriptionForConfig(
       const Config* config,
@@ -0,0 +1,68 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/file_write_queue.h"
+
+#include "gn/filesystem_utils.h"
+#include "gn/output_manifest.h"
+
+FileWriteQueue::FileWriteQueue(size_t thread_count, OutputManifest* manifest)
+    : thread_count_(thread_count), manifest_(manifest), pool_(thread_count) {}
+
+FileWriteQueue::~FileWriteQueue() {
+  Wait(nullptr);
+}
+
+void FileWriteQueue::WriteFileIfChanged(base::FilePath file_path,
+                                        std::string data) {
+  bool start_thread = false;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    pending_writes_.emplace_back(std::move(file_path), std::move(data));
+    unfinished_writes_++;
+
+    // Only wake up another I/O thread when the running ones can't keep up.
+    if (active_threads_ < thread_count_ &&
+        pending_writes_.size() > active_threads_) {
+      active_threads_++;
+      start_thread = true;
+    }
+  }
+  if (start_thread)
+    pool_.PostTask([this]() { ProcessWrites(); });
+}
+
+bool FileWriteQueue::Wait(Err* err) {
+  std::unique_lock<std::mutex> guard(lock_);
+  idle_.wait(guard, [this]() { return unfinished_writes_ == 0; });
+  if (err_.has_error()) {
+    if (err)
+      *err = err_;
+    return false;
+  }
+  return true;
+}
+
+void FileWriteQueue::ProcessWrites() {
+  std::unique_lock<std::mutex> guard(lock_);
+  while (!pending_writes_.empty()) {
+    Write write = std::move(pending_writes_.front());
+    pending_writes_.pop_front();
+    guard.unlock();
+
+    Err err;
+    if (manifest_)
+      manifest_->WriteFileIfChanged(write.first, write.second, &err);
+    else if (!ContentsEqual(write.first, write.second))
+      WriteFile(write.first, write.second, &err);
+
+    guard.lock();
+    if (err.has_error() && !err_.has_error())
+      err_ = err;
+    unfinished_writes_--;
+  }
+  active_threads_--;
+  if (unfinished_writes_ == 0)
+    idle_.notify_all();
+}
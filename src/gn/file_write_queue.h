@@ -0,0 +1,77 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_FILE_WRITE_QUEUE_H_
+#define TOOLS_GN_FILE_WRITE_QUEUE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "base/files/file_path.h"
+#include "gn/err.h"
+#include "util/worker_pool.h"
+
+class OutputManifest;
+
+// Writes generated files on a small pool of dedicated I/O threads, so that
+// the threads producing the contents don't wait on the disk.
+//
+// Files are only written if their contents changed, to avoid touching the
+// timestamps of unchanged files. Writes are queued and each I/O thread
+// processes queued writes in batches until the queue is empty, so the number
+// of concurrent file operations is bounded by the number of I/O threads.
+//
+// This object is thread-safe. The destructor waits for the queued writes.
+class FileWriteQueue {
+ public:
+  // Default number of I/O threads. Writing is mostly bound by the file
+  // system, more threads only add contention.
+  static constexpr size_t kDefaultThreadCount = 4;
+
+  // If |manifest| is not null, it is used to tell whether existing files are
+  // unchanged and records the written files. It must outlive this object.
+  explicit FileWriteQueue(size_t thread_count = kDefaultThreadCount,
+                          OutputManifest* manifest = nullptr);
+  ~FileWriteQueue();
+
+  // Queues writing the given data to the given file if its contents differ.
+  void WriteFileIfChanged(base::FilePath file_path, std::string data);
+
+  // Blocks until all queued writes are done. On failure, sets the error for
+  // the first write that failed and returns false.
+  bool Wait(Err* err);
+
+ private:
+  using Write = std::pair<base::FilePath, std::string>;
+
+  // Runs on the I/O threads, processing queued writes until there are none.
+  void ProcessWrites();
+
+  const size_t thread_count_;
+  OutputManifest* const manifest_;
+
+  std::mutex lock_;
+  std::condition_variable idle_;
+  std::deque<Write> pending_writes_;
+
+  // Number of I/O threads currently running ProcessWrites(), and number of
+  // writes queued or in progress.
+  size_t active_threads_ = 0;
+  size_t unfinished_writes_ = 0;
+
+  // First error encountered.
+  Err err_;
+
+  // Must be last so that its threads are joined before the other members are
+  // destroyed.
+  WorkerPool pool_;
+
+  FileWriteQueue(const FileWriteQueue&) = delete;
+  FileWriteQueue& operator=(const FileWriteQueue&) = delete;
+};
+
+#endif  // TOOLS_GN_FILE_WRITE_QUEUE_H_
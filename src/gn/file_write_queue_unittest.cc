@@ -0,0 +1,62 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/file_write_queue.h"
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/filesystem_utils.h"
+#include "util/test/test.h"
+
+TEST(FileWriteQueue, WriteFiles) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  constexpr int kFiles = 50;
+  auto file_path = [&temp_dir](int i) {
+    return temp_dir.GetPath().AppendASCII("dir" + std::to_string(i % 3))
+        .AppendASCII("file" + std::to_string(i) + ".txt");
+  };
+
+  FileWriteQueue queue(3);
+  for (int i = 0; i < kFiles; i++)
+    queue.WriteFileIfChanged(file_path(i), "contents " + std::to_string(i));
+  Err err;
+  EXPECT_TRUE(queue.Wait(&err));
+  EXPECT_FALSE(err.has_error());
+  for (int i = 0; i < kFiles; i++)
+    EXPECT_TRUE(ContentsEqual(file_path(i), "contents " + std::to_string(i)));
+
+  // Unchanged files are left alone, changed ones are rewritten.
+  for (int i = 0; i < kFiles; i++) {
+    queue.WriteFileIfChanged(file_path(i), i % 2 ? "changed"
+                                                 : "contents " +
+                                                       std::to_string(i));
+  }
+  EXPECT_TRUE(queue.Wait(&err));
+  for (int i = 0; i < kFiles; i++) {
+    EXPECT_TRUE(ContentsEqual(
+        file_path(i), i % 2 ? "changed" : "contents " + std::to_string(i)));
+  }
+}
+
+TEST(FileWriteQueue, Error) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  // A file can't be created below another file.
+  base::FilePath file_path = temp_dir.GetPath().AppendASCII("file.txt");
+  base::FilePath bad_path = file_path.AppendASCII("bad.txt");
+
+  FileWriteQueue queue;
+  queue.WriteFileIfChanged(file_path, "contents");
+  EXPECT_TRUE(queue.Wait(nullptr));
+  queue.WriteFileIfChanged(bad_path, "contents");
+  Err err;
+  EXPECT_FALSE(queue.Wait(&err));
+  EXPECT_TRUE(err.has_error());
+  EXPECT_TRUE(ContentsEqual(file_path, "contents"));
+}
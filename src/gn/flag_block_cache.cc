@@ -0,0 +1,60 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/flag_block_cache.h"
+
+#include <utility>
+
+#include "base/hash.h"
+#include "base/strings/string_number_conversions.h"
+
+FlagBlockCache::FlagBlockCache() = default;
+
+FlagBlockCache::~FlagBlockCache() = default;
+
+const std::string* FlagBlockCache::Find(const std::string& key) const {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto found = blocks_.find(key);
+  if (found == blocks_.end())
+    return nullptr;
+  return &found->second;
+}
+
+const std::string& FlagBlockCache::Insert(std::string key, std::string block) {
+  std::lock_guard<std::mutex> guard(lock_);
+  return blocks_.emplace(std::move(key), std::move(block)).first->second;
+}
+
+size_t FlagBlockCache::size() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return blocks_.size();
+}
+
+std::string FlagBlockCache::GetSharedVariable(std::string_view value) {
+  return GetSharedVariableWithHash(value, base::FastHash64(value));
+}
+
+std::string FlagBlockCache::GetSharedVariableWithHash(std::string_view value,
+                                                      uint64_t hash) {
+  std::string hashed_name = "flags_" + base::HexEncode(&hash, sizeof(hash));
+
+  // 64 bits are plenty to tell the flag sets of a build apart, but should two
+  // values collide anyway, the later ones get a numbered suffix. Hashed names
+  // contain no other underscore, so suffixed names can't clash with them.
+  std::lock_guard<std::mutex> guard(lock_);
+  std::string name = hashed_name;
+  for (int suffix = 1;; suffix++) {
+    auto inserted = variables_.try_emplace(name, value);
+    if (inserted.first->second == value)
+      return name;
+    name = hashed_name + "_" + base::NumberToString(suffix);
+  }
+}
+
+std::vector<std::pair<std::string, std::string>>
+FlagBlockCache::GetSharedVariables() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return std::vector<std::pair<std::string, std::string>>(variables_.begin(),
+                                                          variables_.end());
+}
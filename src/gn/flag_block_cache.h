@@ -0,0 +1,73 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_FLAG_BLOCK_CACHE_H_
+#define TOOLS_GN_FLAG_BLOCK_CACHE_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/hash.h"
+
+// Caches rendered blocks of compiler flag variables ("defines = ...",
+// "cflags = ...", etc.) for one toolchain.
+//
+// Most targets get the same ordered list of configs, so they would all
+// render exactly the same text. The key passed in by the writer describes
+// everything the rendered text depends on (the configs, the target's own
+// values and the writer options), so targets with the same key share the
+// block. This object is thread-safe.
+class FlagBlockCache {
+ public:
+  FlagBlockCache();
+  ~FlagBlockCache();
+
+  // Returns the block previously stored for the given key, or null if there
+  // is none. The returned pointer stays valid for the lifetime of the cache.
+  const std::string* Find(const std::string& key) const;
+
+  // Stores the block for the given key and returns the stored value. If
+  // another thread stored a block for the same key in the meantime, that one
+  // is kept and returned (both are identical anyway).
+  const std::string& Insert(std::string key, std::string block);
+
+  // Returns the number of distinct blocks stored.
+  size_t size() const;
+
+  // Returns the name of a Ninja variable holding the given (already escaped)
+  // value. The name is derived from the value so identical values share one
+  // variable and the names are stable between runs. The variables are
+  // written to the toolchain's Ninja file, see GetSharedVariables().
+  std::string GetSharedVariable(std::string_view value);
+
+  // Same as GetSharedVariable() with the hash of |value| given, so tests can
+  // make the names of different values collide.
+  std::string GetSharedVariableWithHash(std::string_view value, uint64_t hash);
+
+  // Returns the variables created by GetSharedVariable() as (name, value)
+  // pairs sorted by name.
+  std::vector<std::pair<std::string, std::string>> GetSharedVariables() const;
+
+ private:
+  mutable std::mutex lock_;
+
+  // Maps shared variable names to their values.
+  std::map<std::string, std::string> variables_;
+
+  // Nodes of an unordered_map are stable so references to the values can be
+  // handed out.
+  std::unordered_map<std::string, std::string, base::StringHash> blocks_;
+
+  FlagBlockCache(const FlagBlockCache&) = delete;
+  FlagBlockCache& operator=(const FlagBlockCache&) = delete;
+};
+
+#endif  // TOOLS_GN_FLAG_BLOCK_CACHE_H_
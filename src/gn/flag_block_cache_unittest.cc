@@ -0,0 +1,54 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/flag_block_cache.h"
+
+#include "util/test/test.h"
+
+TEST(FlagBlockCache, FindAndInsert) {
+  FlagBlockCache cache;
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Find("a"));
+
+  const std::string& block = cache.Insert("a", "cflags = -O2\n");
+  EXPECT_EQ("cflags = -O2\n", block);
+  EXPECT_EQ(&block, cache.Find("a"));
+  EXPECT_FALSE(cache.Find("b"));
+  EXPECT_EQ(1u, cache.size());
+
+  // Inserting an existing key keeps the first block.
+  EXPECT_EQ(&block, &cache.Insert("a", "other"));
+  EXPECT_EQ("cflags = -O2\n", *cache.Find("a"));
+
+  cache.Insert("b", "cflags = -O0\n");
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(&block, cache.Find("a"));
+  EXPECT_EQ("cflags = -O0\n", *cache.Find("b"));
+}
+
+TEST(FlagBlockCache, SharedVariables) {
+  FlagBlockCache cache;
+  std::string wall = cache.GetSharedVariable("-Wall");
+  EXPECT_EQ(wall, cache.GetSharedVariable("-Wall"));
+  EXPECT_NE(wall, cache.GetSharedVariable("-O2"));
+  EXPECT_EQ(2u, cache.GetSharedVariables().size());
+}
+
+TEST(FlagBlockCache, SharedVariableCollision) {
+  FlagBlockCache cache;
+  std::string first = cache.GetSharedVariableWithHash("-DFIRST", 42);
+  std::string second = cache.GetSharedVariableWithHash("-DSECOND", 42);
+  std::string third = cache.GetSharedVariableWithHash("-DTHIRD", 42);
+  EXPECT_EQ(first + "_1", second);
+  EXPECT_EQ(first + "_2", third);
+
+  // Each value keeps its name.
+  EXPECT_EQ(first, cache.GetSharedVariableWithHash("-DFIRST", 42));
+  EXPECT_EQ(second, cache.GetSharedVariableWithHash("-DSECOND", 42));
+  EXPECT_EQ(third, cache.GetSharedVariableWithHash("-DTHIRD", 42));
+
+  std::vector<std::pair<std::string, std::string>> expected = {
+      {first, "-DFIRST"}, {second, "-DSECOND"}, {third, "-DTHIRD"}};
+  EXPECT_EQ(expected, cache.GetSharedVariables());
+}
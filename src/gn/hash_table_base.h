@@ -483,6 +483,16 @@ class HashTableBase {
     return false;
   }
 
+  // Grow the table if needed so that |count| keys can be stored without
+  // resizing it. Invalidates existing iterators if the table size changed.
+  void NodeReserve(size_t count) {
+    size_t new_size = size_ == 1 ? 8 : size_;
+    while (count * 4 >= new_size * 3)
+      new_size *= 2;
+    if (new_size != size_)
+      ResizeBuckets(new_size);
+  }
+
   // Call this method after updating the content of the |node| value
   // returned a by successful NodeLookup, to the tombstone value, if any.
   // Return true to indicate a table size change, ie. that existing
@@ -494,12 +504,13 @@ class HashTableBase {
   }
 
  private:
+  void GrowBuckets() { ResizeBuckets((size_ == 1) ? 8 : size_ * 2); }
+
 #if defined(__GNUC__) || defined(__clang__)
   [[gnu::noinline]]
 #endif
-  void GrowBuckets() {
+  void ResizeBuckets(size_t new_size) {
     size_t size = size_;
-    size_t new_size = (size == 1) ? 8 : size * 2;
     size_t new_mask = new_size - 1;
 
     // NOTE: Using calloc() since no object constructiopn can or should take
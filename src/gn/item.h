@@ -5,6 +5,9 @@
 #ifndef TOOLS_GN_ITEM_H_
 #define TOOLS_GN_ITEM_H_
 
+#include <stddef.h>
+
+#include <limits>
 #include <set>
 #include <string>
 
@@ -71,6 +74,17 @@ class Item {
   // returns false on failure.
   virtual bool OnResolved(Err* err);
 
+  // Returned by resolved_index() for items that were not resolved by a
+  // Builder.
+  static constexpr size_t kNoResolvedIndex = std::numeric_limits<size_t>::max();
+
+  // A dense index assigned by the Builder when the item is resolved, before
+  // OnResolved() is called. Indices of all resolved items are unique and in
+  // [0, Builder::resolved_item_count()), so they can key plain vectors
+  // instead of hashing pointers.
+  size_t resolved_index() const { return resolved_index_; }
+  void set_resolved_index(size_t index) { resolved_index_ = index; }
+
  private:
   bool CheckTestonly(Err* err) const;
 
@@ -81,6 +95,7 @@ class Item {
 
   bool testonly_ = false;
   Visibility visibility_;
+  size_t resolved_index_ = kNoResolvedIndex;
 };
 
 #endif  // TOOLS_GN_ITEM_H_
@@ -14,11 +14,13 @@
 #include "base/json/json_writer.h"
 #include "base/json/string_escape.h"
 #include "gn/builder.h"
+#include "gn/chunk_renderer.h"
 #include "gn/commands.h"
 #include "gn/deps_iterator.h"
 #include "gn/desc_builder.h"
 #include "gn/filesystem_utils.h"
 #include "gn/invoke_python.h"
+#include "gn/resolved_target_data.h"
 #include "gn/scheduler.h"
 #include "gn/settings.h"
 #include "gn/string_output_buffer.h"
@@ -167,6 +169,9 @@ namespace {
 //
 //   3) Call Close() or destroy the instance to finalize the output.
 //
+// Entries of a dictionary can also be rendered separately, e.g. on another
+// thread, with a fragment writer created with ForFragment(), then inserted
+// with AddFragment().
 class SimpleJSONWriter {
  public:
   // Constructor.
@@ -178,8 +183,17 @@ class SimpleJSONWriter {
   // Destructor.
   ~SimpleJSONWriter() { Close(); }
 
+  // Returns a writer for keys to be inserted in a dictionary at
+  // |indentation|. Its output is not a complete JSON document.
+  static SimpleJSONWriter ForFragment(StringOutputBuffer& out,
+                                      size_t indentation) {
+    return SimpleJSONWriter(out, indentation);
+  }
+
   // Closing finalizes the output.
   void Close() {
+    if (is_fragment_)
+      return;
     if (indentation_ > 0) {
       DCHECK(indentation_ == 1u);
       if (comma_.size())
@@ -280,7 +294,36 @@ class SimpleJSONWriter {
     comma_ = "," LINE_ENDING;
   }
 
+  // Add a key whose value is then written by the caller to the returned
+  // buffer. Lines of the value after the first must be indented for the
+  // current indentation().
+  StringOutputBuffer& AddKey(std::string_view key) {
+    if (comma_.size())
+      out_ << comma_;
+    AddMargin() << Escape(key) << ": ";
+    comma_ = "," LINE_ENDING;
+    return out_;
+  }
+
+  size_t indentation() const { return indentation_; }
+
+  // Add the keys rendered by a fragment writer at the current indentation.
+  // Empty fragments are ignored.
+  void AddFragment(const StringOutputBuffer& fragment) {
+    if (fragment.size() == 0)
+      return;
+    if (comma_.size())
+      out_ << comma_;
+    out_.Append(fragment);
+    comma_ = "," LINE_ENDING;
+  }
+
  private:
+  SimpleJSONWriter(StringOutputBuffer& out, size_t indentation)
+      : is_fragment_(true), out_(out) {
+    SetIndentation(indentation);
+  }
+
   // Return the JSON-escape version of |str|.
   static std::string Escape(std::string_view str) {
     std::string result;
@@ -304,10 +347,22 @@ class SimpleJSONWriter {
   }
 
   size_t indentation_ = 0;
+  bool is_fragment_ = false;
   std::string_view comma_;
   StringOutputBuffer& out_;
 };
 
+// Renders the description of |target| as a key of the "targets" dictionary,
+// directly to the output of |json_writer|.
+void AddTargetDescription(const Target* target,
+                          const std::string& label,
+                          const ResolvedTargetData& resolved,
+                          SimpleJSONWriter* json_writer) {
+  StringOutputBuffer& out = json_writer->AddKey(label);
+  DescBuilder::WriteTargetJSON(target, resolved, json_writer->indentation(),
+                               out);
+}
+
 }  // namespace
 
 StringOutputBuffer JSONProjectWriter::GenerateJSON(
@@ -380,25 +435,36 @@ StringOutputBuffer JSONProjectWriter::GenerateJSON(
   std::map<Label, const Toolchain*> toolchains;
   json_writer.BeginDict("targets");
   {
-    for (const auto* target : sorted_targets) {
-      auto description =
-          DescBuilder::DescriptionForTarget(target, "", false, false, false);
-      // Outputs need to be asked for separately.
-      auto outputs = DescBuilder::DescriptionForTarget(target, "source_outputs",
-                                                       false, false, false);
-      base::DictionaryValue* outputs_value = nullptr;
-      if (outputs->GetDictionary("source_outputs", &outputs_value) &&
-          !outputs_value->empty()) {
-        description->MergeDictionary(outputs.get());
-      }
-
-      std::string json_dict;
-      base::JSONWriter::WriteWithOptions(*description.get(),
-                                         base::JSONWriter::OPTIONS_PRETTY_PRINT,
-                                         &json_dict);
-      json_writer.AddJSONDict(target_labels[target], json_dict);
+    // Chunks of targets are described in parallel, each into its own buffer,
+    // and inserted in order as they finish. A buffer is freed once inserted,
+    // so only the chunks being described are held in memory. The inherited
+    // values of the targets are shared between the chunks.
+    ResolvedTargetData resolved;
+    constexpr size_t kTargetsPerChunk = 64;
+    std::vector<std::unique_ptr<StringOutputBuffer>> chunks(
+        (sorted_targets.size() + kTargetsPerChunk - 1) / kTargetsPerChunk);
+    RenderChunksInOrder(
+        chunks.size(),
+        [&sorted_targets, &target_labels, &resolved, &chunks](size_t chunk) {
+          chunks[chunk] = std::make_unique<StringOutputBuffer>();
+          size_t begin = chunk * kTargetsPerChunk;
+          size_t end =
+              std::min(sorted_targets.size(), begin + kTargetsPerChunk);
+          SimpleJSONWriter chunk_writer =
+              SimpleJSONWriter::ForFragment(*chunks[chunk], 2u);
+          for (size_t i = begin; i < end; i++) {
+            const Target* target = sorted_targets[i];
+            AddTargetDescription(target, target_labels.at(target), resolved,
+                                 &chunk_writer);
+          }
+        },
+        [&json_writer, &chunks](size_t chunk) {
+          json_writer.AddFragment(*chunks[chunk]);
+          chunks[chunk].reset();
+        });
+
+    for (const auto* target : sorted_targets)
       toolchains[target->toolchain()->label()] = target->toolchain();
-    }
   }
   json_writer.EndDict();  // targets
 
@@ -26,6 +26,7 @@ class JSONProjectWriter {
  private:
   FRIEND_TEST_ALL_PREFIXES(JSONWriter, ActionWithResponseFile);
   FRIEND_TEST_ALL_PREFIXES(JSONWriter, ForEachWithResponseFile);
+  FRIEND_TEST_ALL_PREFIXES(JSONWriter, ManyTargets);
   FRIEND_TEST_ALL_PREFIXES(JSONWriter, RustTarget);
 
   static StringOutputBuffer GenerateJSON(
@@ -3,7 +3,21 @@
 // found in the LICENSE file.
 
 #include "gn/json_project_writer.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/command_line.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "gn/commands.h"
+#include "gn/config.h"
+#include "gn/desc_builder.h"
+#include "gn/resolved_target_data.h"
+#include "gn/scope.h"
+#include "gn/string_output_buffer.h"
 #include "gn/substitution_list.h"
 #include "gn/target.h"
 #include "gn/test_with_scheduler.h"
@@ -13,6 +27,38 @@
 
 using JSONWriter = TestWithScheduler;
 
+namespace {
+
+// Describes |target| with DescBuilder and base::JSONWriter, as the JSON
+// project writer used to.
+std::string DescribeWithValues(const Target* target) {
+  ResolvedTargetData resolved;
+  auto description = DescBuilder::DescriptionForTarget(target, resolved, "",
+                                                       false, false, false);
+  auto outputs = DescBuilder::DescriptionForTarget(
+      target, resolved, "source_outputs", false, false, false);
+  base::DictionaryValue* outputs_value = nullptr;
+  if (outputs->GetDictionary("source_outputs", &outputs_value) &&
+      !outputs_value->empty()) {
+    description->MergeDictionary(outputs.get());
+  }
+  std::string json;
+  base::JSONWriter::WriteWithOptions(
+      *description, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+  // Remove the final line ending.
+  json.erase(json.find_last_not_of("\r\n") + 1);
+  return json;
+}
+
+std::string DescribeStreaming(const Target* target) {
+  ResolvedTargetData resolved;
+  StringOutputBuffer out;
+  DescBuilder::WriteTargetJSON(target, resolved, 0, out);
+  return out.str();
+}
+
+}  // namespace
+
 TEST_F(JSONWriter, ActionWithResponseFile) {
   Err err;
   TestWithScope setup;
@@ -753,3 +799,187 @@ TEST_F(JSONWriter, ForEachWithResponseFile) {
 )_";
   EXPECT_EQ(expected_json, out) << out;
 }
+
+// Enough targets to be described in several chunks, which must be assembled
+// into one valid document in label order.
+TEST_F(JSONWriter, ManyTargets) {
+  Err err;
+  TestWithScope setup;
+
+  std::vector<std::unique_ptr<Target>> storage;
+  std::vector<const Target*> targets;
+  constexpr int kNumTargets = 150;
+  for (int i = kNumTargets - 1; i >= 0; i--) {
+    auto target = std::make_unique<Target>(
+        setup.settings(),
+        Label(SourceDir("//foo/"), base::StringPrintf("t%03d", i)));
+    target->set_output_type(Target::SOURCE_SET);
+    target->sources().push_back(
+        SourceFile(base::StringPrintf("//foo/t%03d.cc", i)));
+    target->SetToolchain(setup.toolchain());
+    ASSERT_TRUE(target->OnResolved(&err));
+    targets.push_back(target.get());
+    storage.push_back(std::move(target));
+  }
+
+  std::string out =
+      JSONProjectWriter::RenderJSON(setup.build_settings(), targets);
+  std::unique_ptr<base::Value> value = base::JSONReader::Read(out);
+  ASSERT_TRUE(value);
+  const base::Value* targets_value =
+      value->FindKeyOfType("targets", base::Value::Type::DICTIONARY);
+  ASSERT_TRUE(targets_value);
+  EXPECT_EQ(static_cast<size_t>(kNumTargets), targets_value->DictSize());
+
+  size_t previous = 0;
+  for (int i = 0; i < kNumTargets; i++) {
+    size_t found = out.find(base::StringPrintf("\"//foo:t%03d()\": {", i));
+    ASSERT_NE(std::string::npos, found) << i;
+    EXPECT_LT(previous, found) << i;
+    previous = found;
+  }
+}
+
+// The streaming description of targets must match the one built with
+// base::Value trees.
+TEST_F(JSONWriter, StreamingTargetDescription) {
+  // Describing deps consults the global command-line switches.
+  static const bool switches_initialized = commands::CommandSwitches::Init(
+      base::CommandLine(base::CommandLine::NO_PROGRAM));
+  ASSERT_TRUE(switches_initialized);
+
+  Err err;
+  TestWithScope setup;
+  std::vector<std::unique_ptr<Target>> targets;
+  auto new_target = [&](const char* name, Target::OutputType type) {
+    auto target = std::make_unique<Target>(setup.settings(),
+                                           Label(SourceDir("//foo/"), name));
+    target->set_output_type(type);
+    target->visibility().SetPublic();
+    target->SetToolchain(setup.toolchain());
+    targets.push_back(std::move(target));
+    return targets.back().get();
+  };
+
+  Config config(setup.settings(), Label(SourceDir("//foo/"), "config"));
+  config.own_values().cflags().push_back("-Wall");
+  config.own_values().defines().push_back("FOO");
+  config.own_values().include_dirs().push_back(SourceDir("//include/"));
+  config.own_values().libs().push_back(LibFile("m"));
+  config.own_values().lib_dirs().push_back(SourceDir("//libs/"));
+  config.own_values().frameworks().push_back("Foo.framework");
+  config.own_values().framework_dirs().push_back(SourceDir("//fw/"));
+  config.own_values().externs().push_back(
+      std::make_pair("dep", LibFile(SourceFile("//foo/libdep.rlib"))));
+  config.visibility().SetPublic();
+  ASSERT_TRUE(config.OnResolved(&err));
+
+  Target* lib = new_target("lib", Target::STATIC_LIBRARY);
+  lib->sources().push_back(SourceFile("//foo/lib.cc"));
+  lib->sources().push_back(SourceFile("//foo/lib.h"));
+  lib->set_all_headers_public(false);
+  lib->public_headers().push_back(SourceFile("//foo/lib.h"));
+  lib->public_configs().push_back(LabelConfigPair(&config));
+  lib->config_values().libs().push_back(LibFile(SourceFile("//foo/x.a")));
+  lib->config_values().weak_frameworks().push_back("Weak.framework");
+  ASSERT_TRUE(lib->OnResolved(&err));
+
+  Target* exe = new_target("exe", Target::EXECUTABLE);
+  exe->sources().push_back(SourceFile("//foo/main.cc"));
+  exe->sources().push_back(SourceFile("//foo/main.cc"));
+  exe->set_output_name("app");
+  exe->set_output_extension("bin");
+  exe->set_output_dir(SourceDir("//out/Debug/bin/"));
+  exe->configs().push_back(LabelConfigPair(&config));
+  exe->config_values().defines().push_back("FOO");
+  exe->config_values().defines().push_back("BAR");
+  exe->config_values().cflags_cc().push_back("-std=c++20");
+  exe->config_values().inputs().push_back(SourceFile("//foo/input.txt"));
+  exe->config_values().set_precompiled_header("build/precompile.h");
+  exe->config_values().set_precompiled_source(
+      SourceFile("//build/precompile.cc"));
+  exe->allow_circular_includes_from().insert(lib->label());
+  exe->private_deps().push_back(LabelTargetPair(lib));
+  exe->set_testonly(true);
+  auto scope = std::make_unique<Scope>(setup.settings());
+  scope->SetValue("b", Value(nullptr, true), nullptr);
+  scope->SetValue("a", Value(nullptr, int64_t(42)), nullptr);
+  Value list(nullptr, Value::LIST);
+  list.list_value().push_back(Value(nullptr, "x\"y"));
+  list.list_value().push_back(Value(nullptr, std::move(scope)));
+  list.list_value().push_back(Value(nullptr, Value::NONE));
+  exe->metadata().contents().emplace("zeta", list);
+  exe->metadata().contents().emplace("alpha", Value(nullptr, Value::LIST));
+  auto empty_scope = std::make_unique<Scope>(setup.settings());
+  exe->metadata().contents().emplace(
+      "empty", Value(nullptr, std::move(empty_scope)));
+  ASSERT_TRUE(exe->OnResolved(&err));
+
+  Target* foreach = new_target("foreach", Target::ACTION_FOREACH);
+  foreach->sources().push_back(SourceFile("//foo/a.idl"));
+  foreach->sources().push_back(SourceFile("//foo/b.idl"));
+  foreach->action_values().set_script(SourceFile("//foo/script.py"));
+  foreach->action_values().args() =
+      SubstitutionList::MakeForTest("{{source}}", "--flag");
+  foreach->action_values().outputs() = SubstitutionList::MakeForTest(
+      "//out/Debug/gen/{{source_name_part}}.h",
+      "//out/Debug/gen/{{source_name_part}}.cc");
+  foreach->action_values().set_depfile(
+      SubstitutionPattern::MakeForTest("//out/Debug/gen/{{source_name_part}}.d"));
+  ASSERT_TRUE(foreach->OnResolved(&err));
+
+  Target* copy = new_target("copy", Target::COPY_FILES);
+  copy->sources().push_back(SourceFile("//foo/a.txt"));
+  copy->action_values().outputs() =
+      SubstitutionList::MakeForTest("//out/Debug/{{source_file_part}}");
+  ASSERT_TRUE(copy->OnResolved(&err));
+
+  Target* generated = new_target("generated", Target::GENERATED_FILE);
+  generated->action_values().outputs() =
+      SubstitutionList::MakeForTest("//out/Debug/generated.json");
+  generated->set_output_conversion(Value(nullptr, "json"));
+  generated->data_keys().push_back("data");
+  generated->walk_keys().push_back("walk");
+  generated->set_rebase(SourceDir("//out/Debug/"));
+  ASSERT_TRUE(generated->OnResolved(&err));
+
+  Target* bundle = new_target("bundle", Target::CREATE_BUNDLE);
+  bundle->bundle_data().root_dir() = SourceDir("//out/Debug/bar.bundle/");
+  bundle->bundle_data().resources_dir() =
+      SourceDir("//out/Debug/bar.bundle/Resources/");
+  bundle->bundle_data().product_type().assign("com.apple.product-type");
+  bundle->private_deps().push_back(LabelTargetPair(lib));
+  ASSERT_TRUE(bundle->OnResolved(&err));
+
+  Target* rust = new_target("rust", Target::RUST_LIBRARY);
+  SourceFile rust_root("//foo/lib.rs");
+  rust->sources().push_back(rust_root);
+  rust->source_types_used().Set(SourceFile::SOURCE_RS);
+  rust->rust_values().set_crate_root(rust_root);
+  rust->rust_values().crate_name() = "foo";
+  ASSERT_TRUE(rust->OnResolved(&err));
+
+  Target* group = new_target("group", Target::GROUP);
+  group->set_testonly(true);
+  group->public_deps().push_back(LabelTargetPair(exe));
+  ASSERT_TRUE(group->OnResolved(&err));
+
+  for (const auto& target : targets) {
+    EXPECT_EQ(DescribeWithValues(target.get()),
+              DescribeStreaming(target.get()))
+        << target->label().GetUserVisibleName(false);
+  }
+
+  // Nested dictionaries are indented for their depth.
+  ResolvedTargetData resolved;
+  StringOutputBuffer nested;
+  DescBuilder::WriteTargetJSON(exe, resolved, 2, nested);
+  std::string expected;
+  for (char c : DescribeWithValues(exe)) {
+    if (!expected.empty() && expected.back() == '\n' && c != '\n' &&
+        c != '\r')
+      expected.append(6, ' ');
+    expected.push_back(c);
+  }
+  EXPECT_EQ(expected, nested.str());
+}
@@ -0,0 +1,127 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/label_pattern_matcher.h"
+
+#include "base/logging.h"
+
+bool LabelPatternMatcher::ToolchainSet::Matches(const Label& label) const {
+  if (all_toolchains)
+    return true;
+  for (const Label& toolchain : toolchains) {
+    if (toolchain.dir() == label.toolchain_dir() &&
+        toolchain.name() == label.toolchain_name())
+      return true;
+  }
+  return false;
+}
+
+void LabelPatternMatcher::ToolchainSet::Add(const Label& toolchain) {
+  // A null toolchain in a pattern means it applies to all toolchains.
+  if (toolchain.is_null())
+    all_toolchains = true;
+  else if (!all_toolchains)
+    toolchains.push_back(toolchain);
+}
+
+LabelPatternMatcher::Node::Node() = default;
+LabelPatternMatcher::Node::~Node() = default;
+
+LabelPatternMatcher::LabelPatternMatcher() = default;
+
+LabelPatternMatcher::LabelPatternMatcher(
+    const std::vector<LabelPattern>& patterns) {
+  if (patterns.size() <= kMaxLinearPatterns) {
+    linear_patterns_ = patterns;
+    return;
+  }
+  for (const LabelPattern& pattern : patterns)
+    AddToTrie(pattern);
+}
+
+LabelPatternMatcher::~LabelPatternMatcher() = default;
+
+LabelPatternMatcher::LabelPatternMatcher(LabelPatternMatcher&&) = default;
+LabelPatternMatcher& LabelPatternMatcher::operator=(LabelPatternMatcher&&) =
+    default;
+
+bool LabelPatternMatcher::Matches(const Label& label) const {
+  if (!linear_patterns_.empty() &&
+      LabelPattern::VectorMatches(linear_patterns_, label))
+    return true;
+  if (!root_)
+    return false;
+
+  // Walk the directory of the label one component at a time. Any recursive
+  // pattern found on the way is a prefix of the label's directory.
+  std::string_view dir = label.dir().value();
+  const Node* node = root_.get();
+  size_t begin = 0;
+  for (;;) {
+    if (node->recursive.Matches(label))
+      return true;
+    if (begin >= dir.size())
+      break;
+
+    size_t slash = dir.find('/', begin);
+    if (slash == std::string_view::npos)
+      return false;
+    auto found = node->children.find(dir.substr(begin, slash - begin));
+    if (found == node->children.end())
+      return false;
+    node = found->second.get();
+    begin = slash + 1;
+  }
+
+  // The node now corresponds to the label's own directory.
+  if (node->directory.Matches(label))
+    return true;
+  auto found = node->names.find(label.name());
+  return found != node->names.end() && found->second.Matches(label);
+}
+
+void LabelPatternMatcher::AddToTrie(const LabelPattern& pattern) {
+  // Directories are matched by component, which relies on the usual trailing
+  // slash. Anything else keeps the prefix semantics of LabelPattern::Matches.
+  std::string_view dir = pattern.dir().value();
+  if (!dir.empty() && dir.back() != '/') {
+    linear_patterns_.push_back(pattern);
+    return;
+  }
+
+  if (!root_)
+    root_ = std::make_unique<Node>();
+  Node* node = root_.get();
+  size_t begin = 0;
+  while (begin < dir.size()) {
+    size_t slash = dir.find('/', begin);
+    std::string_view component = dir.substr(begin, slash - begin);
+    auto found = node->children.find(component);
+    if (found == node->children.end()) {
+      found = node->children
+                  .emplace(std::string(component), std::make_unique<Node>())
+                  .first;
+    }
+    node = found->second.get();
+    begin = slash + 1;
+  }
+
+  switch (pattern.type()) {
+    case LabelPattern::MATCH: {
+      auto found = node->names.find(pattern.name());
+      if (found == node->names.end())
+        found = node->names.emplace(pattern.name(), ToolchainSet()).first;
+      found->second.Add(pattern.toolchain());
+      break;
+    }
+    case LabelPattern::DIRECTORY:
+      node->directory.Add(pattern.toolchain());
+      break;
+    case LabelPattern::RECURSIVE_DIRECTORY:
+      node->recursive.Add(pattern.toolchain());
+      break;
+    default:
+      NOTREACHED();
+  }
+}
@@ -0,0 +1,83 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_LABEL_PATTERN_MATCHER_H_
+#define TOOLS_GN_LABEL_PATTERN_MATCHER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gn/label.h"
+#include "gn/label_pattern.h"
+
+// Matches labels against a list of label patterns, equivalent to
+// LabelPattern::VectorMatches() but without testing every pattern.
+//
+// The patterns are compiled into a trie over the directory components of
+// their directories. Matching a label walks its directory once, checking
+// recursive-directory patterns at every level and directory and exact-name
+// patterns at the label's own directory. This is intended for long pattern
+// lists (visibility, assert_no_deps, command line filters) which are matched
+// against many labels. Short lists are scanned linearly since that is faster
+// than walking the trie.
+class LabelPatternMatcher {
+ public:
+  // Pattern lists at most this long are matched linearly.
+  static constexpr size_t kMaxLinearPatterns = 8;
+
+  LabelPatternMatcher();
+  explicit LabelPatternMatcher(const std::vector<LabelPattern>& patterns);
+  ~LabelPatternMatcher();
+
+  LabelPatternMatcher(LabelPatternMatcher&&);
+  LabelPatternMatcher& operator=(LabelPatternMatcher&&);
+
+  // Returns true if any of the patterns match the label.
+  bool Matches(const Label& label) const;
+
+  bool empty() const { return linear_patterns_.empty() && !root_; }
+
+ private:
+  // The toolchains a pattern terminating at a given trie node applies to.
+  struct ToolchainSet {
+    bool Matches(const Label& label) const;
+    void Add(const Label& toolchain);
+
+    bool all_toolchains = false;
+    std::vector<Label> toolchains;
+  };
+
+  struct Node {
+    Node();
+    ~Node();
+
+    // Patterns of the form "<dir>/*", matching this directory and any
+    // subdirectory.
+    ToolchainSet recursive;
+
+    // Patterns of the form "<dir>:*", matching only this directory.
+    ToolchainSet directory;
+
+    // Exact label patterns in this directory, indexed by name.
+    std::map<std::string, ToolchainSet, std::less<>> names;
+
+    std::map<std::string, std::unique_ptr<Node>, std::less<>> children;
+  };
+
+  void AddToTrie(const LabelPattern& pattern);
+
+  // Patterns matched by scanning. These are either all of the patterns for
+  // short lists, or those that cannot be represented in the trie.
+  std::vector<LabelPattern> linear_patterns_;
+
+  std::unique_ptr<Node> root_;
+
+  LabelPatternMatcher(const LabelPatternMatcher&) = delete;
+  LabelPatternMatcher& operator=(const LabelPatternMatcher&) = delete;
+};
+
+#endif  // TOOLS_GN_LABEL_PATTERN_MATCHER_H_
@@ -0,0 +1,95 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/label_pattern_matcher.h"
+
+#include <iterator>
+
+#include "gn/err.h"
+#include "gn/value.h"
+#include "util/test/test.h"
+
+namespace {
+
+std::vector<LabelPattern> MakePatterns(
+    const std::vector<const char*>& inputs) {
+  SourceDir current_dir("//foo/");
+  std::vector<LabelPattern> result;
+  for (const char* input : inputs) {
+    Err err;
+    result.push_back(LabelPattern::GetPattern(
+        current_dir, std::string_view(), Value(nullptr, input), &err));
+    EXPECT_FALSE(err.has_error()) << input;
+  }
+  return result;
+}
+
+Label MakeLabel(const char* dir, const char* name, const char* toolchain_dir) {
+  return Label(SourceDir(dir), name, SourceDir(toolchain_dir), "tc");
+}
+
+}  // namespace
+
+TEST(LabelPatternMatcher, Empty) {
+  LabelPatternMatcher matcher;
+  EXPECT_TRUE(matcher.empty());
+  EXPECT_FALSE(matcher.Matches(MakeLabel("//foo/", "bar", "//tc/")));
+
+  LabelPatternMatcher from_empty_list{std::vector<LabelPattern>()};
+  EXPECT_TRUE(from_empty_list.empty());
+  EXPECT_FALSE(from_empty_list.Matches(MakeLabel("//foo/", "bar", "//tc/")));
+}
+
+// Checks the trie against LabelPattern::VectorMatches() for a list long enough
+// to not be scanned linearly.
+TEST(LabelPatternMatcher, MatchesLikeVector) {
+  std::vector<LabelPattern> patterns = MakePatterns({
+      ":bar",
+      "//la:bar",
+      "//la:*",
+      "//l/*",
+      "//deep/a/b/*",
+      "//deep/a:x",
+      "//tc_only:name(//tc:tc)",
+      "//tc_dir:*(//other:tc)",
+      "//tc_rec/*(//tc:tc)",
+      "/abs/*",
+      "/abs2:thing",
+  });
+  ASSERT_GT(patterns.size(), LabelPatternMatcher::kMaxLinearPatterns);
+  LabelPatternMatcher matcher(patterns);
+  EXPECT_FALSE(matcher.empty());
+
+  const char* kDirs[] = {
+      "//",          "//foo/",     "//foo/bar/", "//la/",       "//la/sub/",
+      "//l/",        "//l/x/y/",   "//ll/",      "//deep/",     "//deep/a/",
+      "//deep/a/b/", "//deep/a/b/c/", "//tc_only/", "//tc_dir/", "//tc_rec/",
+      "//tc_rec/z/", "/abs/",      "/abs/q/",    "/abs2/",      "/",
+  };
+  const char* kNames[] = {"bar", "x", "name", "thing", "other"};
+  const char* kToolchainDirs[] = {"//tc/", "//other/"};
+  for (const char* dir : kDirs) {
+    for (const char* name : kNames) {
+      for (const char* toolchain_dir : kToolchainDirs) {
+        Label label = MakeLabel(dir, name, toolchain_dir);
+        EXPECT_EQ(LabelPattern::VectorMatches(patterns, label),
+                  matcher.Matches(label))
+            << label.GetUserVisibleName(true);
+      }
+    }
+  }
+}
+
+TEST(LabelPatternMatcher, Public) {
+  // The public visibility pattern (empty recursive directory) matches
+  // everything, even among many other patterns.
+  std::vector<LabelPattern> patterns = MakePatterns(
+      {"//a:a", "//b:b", "//c:c", "//d:d", "//e:e", "//f:f", "//g:g", "//h:h"});
+  patterns.push_back(LabelPattern(LabelPattern::RECURSIVE_DIRECTORY,
+                                  SourceDir(), std::string(), Label()));
+  LabelPatternMatcher matcher(patterns);
+  EXPECT_TRUE(matcher.Matches(MakeLabel("//", "x", "//tc/")));
+  EXPECT_TRUE(matcher.Matches(MakeLabel("//some/dir/", "x", "//tc/")));
+  EXPECT_TRUE(matcher.Matches(MakeLabel("/abs/", "x", "//tc/")));
+}
@@ -11,6 +11,7 @@
 #include <string>
 #include <string_view>
 
+#include "base/hash.h"
 #include "gn/source_file.h"
 
 // Represents an entry in "libs" list. Can be either a path (a SourceFile) or
@@ -44,8 +45,7 @@ namespace std {
 template <>
 struct hash<LibFile> {
   std::size_t operator()(const LibFile& v) const {
-    hash<std::string> h;
-    return h(v.value());
+    return base::FastHash(v.value());
   }
 };
 
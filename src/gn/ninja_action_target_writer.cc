@@ -6,6 +6,9 @@
 
 #include <stddef.h>
 
+#include <optional>
+#include <utility>
+
 #include "base/strings/string_util.h"
 #include "gn/deps_iterator.h"
 #include "gn/err.h"
@@ -110,7 +113,9 @@ void NinjaActionTargetWriter::Run() {
 
     out_ << std::endl;
     if (target_->action_values().has_depfile()) {
-      WriteDepfile(SourceFile());
+      WriteDepfile(SubstitutionWriter::ApplyPatternToSourceAsOutputFile(
+          target_, settings_, target_->action_values().depfile(),
+          SourceFile()));
     }
 
     WriteNinjaVariablesForAction();
@@ -173,9 +178,7 @@ std::string NinjaActionTargetWriter::WriteRuleDefinition() {
 
   // The command line requires shell escaping to properly handle filenames
   // with spaces.
-  PathOutput command_output(path_output_.current_dir(),
-                            settings_->build_settings()->root_path_utf8(),
-                            ESCAPE_NINJA_COMMAND);
+  PathOutput command_output(path_output_, ESCAPE_NINJA_COMMAND);
 
   out_ << "  command = ";
   command_output.WriteFile(out_, settings_->build_settings()->python_path());
@@ -214,10 +217,34 @@ void NinjaActionTargetWriter::WriteSourceRules(
   // they will get pasted into the real command line.
   args_escape_options.inhibit_quoting = true;
 
+  // The patterns are applied to every source, compile them once.
+  const ActionValues& action_values = target_->action_values();
+  std::vector<CompiledSubstitutionPattern> outputs =
+      CompiledSubstitutionPattern::CompileList(target_, settings_,
+                                               action_values.outputs());
+  std::optional<CompiledSubstitutionPattern> depfile;
+  if (action_values.has_depfile())
+    depfile.emplace(target_, settings_, action_values.depfile());
+
+  // The required types is the union of the args and response file. This
+  // might theoretically duplicate a definition if the same substitution is
+  // used in both the args and the response file. However, this should be
+  // very unusual (normally the substitutions will go in one place or the
+  // other) and the redundant assignment won't bother Ninja.
+  std::vector<CompiledSubstitutionPattern> variables =
+      SubstitutionWriter::CompileNinjaVariablesForSource(
+          target_, settings_, action_values.args().required_types());
+  std::vector<CompiledSubstitutionPattern> rsp_variables =
+      SubstitutionWriter::CompileNinjaVariablesForSource(
+          target_, settings_,
+          action_values.rsp_file_contents().required_types());
+  for (auto& variable : rsp_variables)
+    variables.push_back(std::move(variable));
+
   const Target::FileList& sources = target_->sources();
   for (size_t i = 0; i < sources.size(); i++) {
     out_ << "build";
-    WriteOutputFilesForBuildLine(sources[i], output_files);
+    WriteOutputFilesForBuildLine(outputs, sources[i], output_files);
 
     out_ << ": " << custom_rule_name << " ";
     path_output_.WriteFile(out_, sources[i]);
@@ -238,27 +265,15 @@ void NinjaActionTargetWriter::WriteSourceRules(
     out_ << std::endl;
 
     // Response files require a unique name be defined.
-    if (target_->action_values().uses_rsp_file())
+    if (action_values.uses_rsp_file())
       out_ << "  unique_name = " << i << std::endl;
 
-    // The required types is the union of the args and response file. This
-    // might theoretically duplicate a definition if the same substitution is
-    // used in both the args and the response file. However, this should be
-    // very unusual (normally the substitutions will go in one place or the
-    // other) and the redundant assignment won't bother Ninja.
-    SubstitutionWriter::WriteNinjaVariablesForSource(
-        target_, settings_, sources[i],
-        target_->action_values().args().required_types(), args_escape_options,
-        out_);
     SubstitutionWriter::WriteNinjaVariablesForSource(
-        target_, settings_, sources[i],
-        target_->action_values().rsp_file_contents().required_types(),
-        args_escape_options, out_);
+        variables, sources[i], args_escape_options, out_);
     WriteNinjaVariablesForAction();
 
-    if (target_->action_values().has_depfile()) {
-      WriteDepfile(sources[i]);
-    }
+    if (depfile)
+      WriteDepfile(depfile->ApplyToSourceAsOutputFile(sources[i]));
     if (target_->pool().ptr) {
       out_ << "  pool = ";
       out_ << target_->pool().ptr->GetNinjaName(
@@ -269,13 +284,13 @@ void NinjaActionTargetWriter::WriteSourceRules(
 }
 
 void NinjaActionTargetWriter::WriteOutputFilesForBuildLine(
+    const std::vector<CompiledSubstitutionPattern>& outputs,
     const SourceFile& source,
     std::vector<OutputFile>* output_files) {
   size_t first_output_index = output_files->size();
 
-  SubstitutionWriter::ApplyListToSourceAsOutputFile(
-      target_, settings_, target_->action_values().outputs(), source,
-      output_files);
+  for (const auto& output : outputs)
+    output_files->push_back(output.ApplyToSourceAsOutputFile(source));
 
   for (size_t i = first_output_index; i < output_files->size(); i++) {
     out_ << " ";
@@ -283,12 +298,9 @@ void NinjaActionTargetWriter::WriteOutputFilesForBuildLine(
   }
 }
 
-void NinjaActionTargetWriter::WriteDepfile(const SourceFile& source) {
+void NinjaActionTargetWriter::WriteDepfile(const OutputFile& depfile) {
   out_ << "  depfile = ";
-  path_output_.WriteFile(
-      out_,
-      SubstitutionWriter::ApplyPatternToSourceAsOutputFile(
-          target_, settings_, target_->action_values().depfile(), source));
+  path_output_.WriteFile(out_, depfile);
   out_ << std::endl;
   // Using "deps = gcc" allows Ninja to read and store the depfile content in
   // its internal database which improves performance, especially for large
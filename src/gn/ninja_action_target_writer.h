@@ -10,6 +10,7 @@
 #include "base/gtest_prod_util.h"
 #include "gn/ninja_target_writer.h"
 
+class CompiledSubstitutionPattern;
 class OutputFile;
 
 // Writes a .ninja file for a action target type.
@@ -43,13 +44,15 @@ class NinjaActionTargetWriter : public NinjaTargetWriter {
                         const std::vector<OutputFile>& order_only_deps,
                         std::vector<OutputFile>* output_files);
 
-  // Writes the output files generated by the output template for the given
-  // source file. This will start with a space and will not include a newline.
-  // Appends the output files to the given vector.
-  void WriteOutputFilesForBuildLine(const SourceFile& source,
-                                    std::vector<OutputFile>* output_files);
+  // Writes the output files generated by the compiled output templates for
+  // the given source file. This will start with a space and will not include
+  // a newline. Appends the output files to the given vector.
+  void WriteOutputFilesForBuildLine(
+      const std::vector<CompiledSubstitutionPattern>& outputs,
+      const SourceFile& source,
+      std::vector<OutputFile>* output_files);
 
-  void WriteDepfile(const SourceFile& source);
+  void WriteDepfile(const OutputFile& depfile);
 
   // Writes variables that we make available to all actions, irrespective
   // of whether they're associated with a specific source file.
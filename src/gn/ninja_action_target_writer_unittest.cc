@@ -9,6 +9,7 @@
 #include "gn/ninja_action_target_writer.h"
 #include "gn/pool.h"
 #include "gn/substitution_list.h"
+#include "gn/substitution_writer.h"
 #include "gn/target.h"
 #include "gn/test_with_scope.h"
 #include "util/build_config.h"
@@ -32,7 +33,10 @@ TEST(NinjaActionTargetWriter, WriteOutputFilesForBuildLine) {
 
   SourceFile source("//foo/bar.in");
   std::vector<OutputFile> output_files;
-  writer.WriteOutputFilesForBuildLine(source, &output_files);
+  writer.WriteOutputFilesForBuildLine(
+      CompiledSubstitutionPattern::CompileList(
+          &target, setup.settings(), target.action_values().outputs()),
+      source, &output_files);
 
   EXPECT_EQ(" gen/a$ bbar.h gen/bar.cc", out.str());
 }
@@ -123,6 +123,13 @@ NinjaBinaryTargetWriter::WriteInputsStampOrPhonyAndGetDep(
   return {stamp_or_phony};
 }
 
+const std::vector<TargetPublicPair>&
+NinjaBinaryTargetWriter::GetInheritedLibraries() const {
+  if (!inherited_libraries_)
+    inherited_libraries_ = resolved().GetInheritedLibraries(target_);
+  return *inherited_libraries_;
+}
+
 NinjaBinaryTargetWriter::ClassifiedDeps
 NinjaBinaryTargetWriter::GetClassifiedDeps() const {
   ClassifiedDeps classified_deps;
@@ -135,7 +142,7 @@ NinjaBinaryTargetWriter::GetClassifiedDeps() const {
   }
 
   // Inherited libraries.
-  for (const auto& inherited : resolved().GetInheritedLibraries(target_)) {
+  for (const auto& inherited : GetInheritedLibraries()) {
     ClassifyDependency(inherited.target(), &classified_deps);
   }
 
@@ -325,9 +332,7 @@ void NinjaBinaryTargetWriter::WriteLibrarySearchPath(std::ostream& out,
   if (!all_lib_dirs.empty()) {
     // Since we're passing these on the command line to the linker and not
     // to Ninja, we need to do shell escaping.
-    PathOutput lib_path_output(path_output_.current_dir(),
-                               settings_->build_settings()->root_path_utf8(),
-                               ESCAPE_NINJA_COMMAND);
+    PathOutput lib_path_output(path_output_, ESCAPE_NINJA_COMMAND);
     for (size_t i = 0; i < all_lib_dirs.size(); i++) {
       out << " " << tool->lib_dir_switch();
       lib_path_output.WriteDir(out, all_lib_dirs[i],
@@ -339,9 +344,7 @@ void NinjaBinaryTargetWriter::WriteLibrarySearchPath(std::ostream& out,
   if (!all_framework_dirs.empty()) {
     // Since we're passing these on the command line to the linker and not
     // to Ninja, we need to do shell escaping.
-    PathOutput framework_path_output(
-        path_output_.current_dir(),
-        settings_->build_settings()->root_path_utf8(), ESCAPE_NINJA_COMMAND);
+    PathOutput framework_path_output(path_output_, ESCAPE_NINJA_COMMAND);
     for (size_t i = 0; i < all_framework_dirs.size(); i++) {
       out << " " << tool->framework_dir_switch();
       framework_path_output.WriteDir(out, all_framework_dirs[i],
@@ -369,9 +372,7 @@ void NinjaBinaryTargetWriter::WriteLibs(std::ostream& out, const Tool* tool) {
   // Libraries that have been recursively pushed through the dependency tree.
   // Since we're passing these on the command line to the linker and not
   // to Ninja, we need to do shell escaping.
-  PathOutput lib_path_output(path_output_.current_dir(),
-                             settings_->build_settings()->root_path_utf8(),
-                             ESCAPE_NINJA_COMMAND);
+  PathOutput lib_path_output(path_output_, ESCAPE_NINJA_COMMAND);
   EscapeOptions lib_escape_opts;
   lib_escape_opts.mode = ESCAPE_NINJA_COMMAND;
   const auto& all_libs = resolved().GetLinkedLibraries(target_);
@@ -410,9 +411,7 @@ void NinjaBinaryTargetWriter::WriteSwiftModules(
     const std::vector<OutputFile>& swiftmodules) {
   // Since we're passing these on the command line to the linker and not
   // to Ninja, we need to do shell escaping.
-  PathOutput swiftmodule_path_output(
-      path_output_.current_dir(), settings_->build_settings()->root_path_utf8(),
-      ESCAPE_NINJA_COMMAND);
+  PathOutput swiftmodule_path_output(path_output_, ESCAPE_NINJA_COMMAND);
 
   for (const OutputFile& swiftmodule : swiftmodules) {
     out << " " << tool->swiftmodule_switch();
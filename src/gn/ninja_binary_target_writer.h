@@ -5,9 +5,13 @@
 #ifndef TOOLS_GN_NINJA_BINARY_TARGET_WRITER_H_
 #define TOOLS_GN_NINJA_BINARY_TARGET_WRITER_H_
 
+#include <optional>
+#include <vector>
+
 #include "gn/c_tool.h"
 #include "gn/config_values.h"
 #include "gn/ninja_target_writer.h"
+#include "gn/target_public_pair.h"
 #include "gn/toolchain.h"
 #include "gn/unique_vector.h"
 
@@ -42,6 +46,10 @@ class NinjaBinaryTargetWriter : public NinjaTargetWriter {
   std::vector<OutputFile> WriteInputsStampOrPhonyAndGetDep(
       size_t num_phony_uses) const;
 
+  // Returns the libraries inherited by the target. They are flattened from
+  // ResolvedTargetData on first use, and kept for the other uses.
+  const std::vector<TargetPublicPair>& GetInheritedLibraries() const;
+
   // Gets all target dependencies and classifies them, as well as accumulates
   // object files from source sets we need to link.
   ClassifiedDeps GetClassifiedDeps() const;
@@ -80,6 +88,8 @@ class NinjaBinaryTargetWriter : public NinjaTargetWriter {
   std::string rule_prefix_;
 
  private:
+  mutable std::optional<std::vector<TargetPublicPair>> inherited_libraries_;
+
   NinjaBinaryTargetWriter(const NinjaBinaryTargetWriter&) = delete;
   NinjaBinaryTargetWriter& operator=(const NinjaBinaryTargetWriter&) = delete;
 };
@@ -648,7 +648,7 @@ void NinjaCBinaryTargetWriter::WriteLinkerStuff(
   // rlibs only depended on inside a shared library dependency).
   std::vector<OutputFile> transitive_rustlibs;
   if (target_->IsFinal()) {
-    for (const auto& inherited : resolved().GetInheritedLibraries(target_)) {
+    for (const auto& inherited : GetInheritedLibraries()) {
       const Target* dep = inherited.target();
       if (dep->output_type() == Target::RUST_LIBRARY) {
         CHECK(dep->has_dependency_output_file());
@@ -750,9 +750,7 @@ void NinjaCBinaryTargetWriter::WriteLibsList(
     return;
 
   out_ << "  " << label << " =";
-  PathOutput output(path_output_.current_dir(),
-                    settings_->build_settings()->root_path_utf8(),
-                    ESCAPE_NINJA_COMMAND);
+  PathOutput output(path_output_, ESCAPE_NINJA_COMMAND);
   output.WriteFiles(out_, libs);
   out_ << std::endl;
 }
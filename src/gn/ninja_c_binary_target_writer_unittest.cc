@@ -4,6 +4,7 @@
 
 #include "gn/ninja_c_binary_target_writer.h"
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <utility>
@@ -2814,3 +2815,109 @@ TEST_F(NinjaCBinaryTargetWriterTest, Pool) {
   std::string out_str = out.str();
   EXPECT_EQ(expected, out_str) << expected << "\n" << out_str;
 }
+
+// Targets with the same configs and values share their rendered flags.
+TEST_F(NinjaCBinaryTargetWriterTest, SharedFlagBlocks) {
+  TestWithScope setup;
+  Err err;
+
+  Config config(setup.settings(), Label(SourceDir("//foo/"), "config"));
+  config.visibility().SetPublic();
+  config.own_values().defines().push_back("SHARED");
+  config.own_values().cflags().push_back("-Wall");
+  ASSERT_TRUE(config.OnResolved(&err));
+
+  TestTarget first(setup, "//foo:first", Target::SOURCE_SET);
+  first.sources().push_back(SourceFile("//foo/first.cc"));
+  first.source_types_used().Set(SourceFile::SOURCE_CPP);
+  first.configs().push_back(LabelConfigPair(&config));
+  ASSERT_TRUE(first.OnResolved(&err));
+
+  TestTarget second(setup, "//foo:second", Target::SOURCE_SET);
+  second.sources().push_back(SourceFile("//foo/second.cc"));
+  second.source_types_used().Set(SourceFile::SOURCE_CPP);
+  second.configs().push_back(LabelConfigPair(&config));
+  ASSERT_TRUE(second.OnResolved(&err));
+
+  TestTarget local(setup, "//foo:local", Target::SOURCE_SET);
+  local.sources().push_back(SourceFile("//foo/local.cc"));
+  local.source_types_used().Set(SourceFile::SOURCE_CPP);
+  local.configs().push_back(LabelConfigPair(&config));
+  local.config_values().defines().push_back("LOCAL");
+  ASSERT_TRUE(local.OnResolved(&err));
+
+  const char expected_flags[] =
+      "defines = -DSHARED\n"
+      "include_dirs =\n"
+      "cflags = -Wall\n"
+      "cflags_cc =\n";
+  const char expected_local_flags[] =
+      "defines = -DLOCAL -DSHARED\n"
+      "include_dirs =\n"
+      "cflags = -Wall\n"
+      "cflags_cc =\n";
+
+  std::ostringstream first_out;
+  NinjaCBinaryTargetWriter(&first, first_out).Run();
+  EXPECT_EQ(0u, first_out.str().find(expected_flags)) << first_out.str();
+  EXPECT_EQ(1u, setup.settings()->flag_block_cache().size());
+
+  std::ostringstream second_out;
+  NinjaCBinaryTargetWriter(&second, second_out).Run();
+  EXPECT_EQ(0u, second_out.str().find(expected_flags)) << second_out.str();
+  EXPECT_EQ(1u, setup.settings()->flag_block_cache().size());
+
+  std::ostringstream local_out;
+  NinjaCBinaryTargetWriter(&local, local_out).Run();
+  EXPECT_EQ(0u, local_out.str().find(expected_local_flags))
+      << local_out.str();
+  EXPECT_EQ(2u, setup.settings()->flag_block_cache().size());
+}
+
+// With ninja_shared_flag_sets, flag values are referenced from variables of
+// the toolchain's Ninja file.
+TEST_F(NinjaCBinaryTargetWriterTest, SharedFlagSets) {
+  TestWithScope setup;
+  setup.build_settings()->set_ninja_shared_flag_sets(true);
+  Err err;
+
+  TestTarget first(setup, "//foo:first", Target::SOURCE_SET);
+  first.sources().push_back(SourceFile("//foo/first.cc"));
+  first.source_types_used().Set(SourceFile::SOURCE_CPP);
+  first.config_values().cflags().push_back("-Wall");
+  first.config_values().defines().push_back("FIRST");
+  ASSERT_TRUE(first.OnResolved(&err));
+
+  TestTarget second(setup, "//foo:second", Target::SOURCE_SET);
+  second.sources().push_back(SourceFile("//foo/second.cc"));
+  second.source_types_used().Set(SourceFile::SOURCE_CPP);
+  second.config_values().cflags().push_back("-Wall");
+  ASSERT_TRUE(second.OnResolved(&err));
+
+  FlagBlockCache& cache = setup.settings()->flag_block_cache();
+  std::string wall = cache.GetSharedVariable("-Wall");
+  std::string first_defines = cache.GetSharedVariable("-DFIRST");
+
+  std::ostringstream first_out;
+  NinjaCBinaryTargetWriter(&first, first_out).Run();
+  std::string expected_first =
+      "defines = $" + first_defines + "\n" +
+      "include_dirs =\n"
+      "cflags = $" + wall + "\n" +
+      "cflags_cc =\n";
+  EXPECT_EQ(0u, first_out.str().find(expected_first)) << first_out.str();
+
+  std::ostringstream second_out;
+  NinjaCBinaryTargetWriter(&second, second_out).Run();
+  std::string expected_second =
+      "defines =\n"
+      "include_dirs =\n"
+      "cflags = $" + wall + "\n" +
+      "cflags_cc =\n";
+  EXPECT_EQ(0u, second_out.str().find(expected_second)) << second_out.str();
+
+  std::vector<std::pair<std::string, std::string>> expected_variables = {
+      {first_defines, "-DFIRST"}, {wall, "-Wall"}};
+  std::sort(expected_variables.begin(), expected_variables.end());
+  EXPECT_EQ(expected_variables, cache.GetSharedVariables());
+}
@@ -108,10 +108,11 @@ void NinjaCopyTargetWriter::WriteCopyRules(
   // to avoid conflicts. This is also needed for data_deps on a copy target.
   // Such cases should be avoided where possible, but sometimes that's not
   // possible.
+  CompiledSubstitutionPattern output_pattern(target_, target_->settings(),
+                                             output_subst);
   for (const auto& input_file : target_->sources()) {
     OutputFile output_file =
-        SubstitutionWriter::ApplyPatternToSourceAsOutputFile(
-            target_, target_->settings(), output_subst, input_file);
+        output_pattern.ApplyToSourceAsOutputFile(input_file);
     output_files->push_back(output_file);
 
     out_ << "build ";
@@ -4,7 +4,12 @@
 
 #include "gn/ninja_target_writer.h"
 
+#include <algorithm>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "base/files/file_util.h"
 #include "base/strings/string_util.h"
@@ -13,7 +18,9 @@
 #include "gn/config_values_extractors.h"
 #include "gn/err.h"
 #include "gn/escape.h"
+#include "gn/file_write_queue.h"
 #include "gn/filesystem_utils.h"
+#include "gn/flag_block_cache.h"
 #include "gn/general_tool.h"
 #include "gn/ninja_action_target_writer.h"
 #include "gn/ninja_binary_target_writer.h"
@@ -27,12 +34,213 @@
 #include "gn/output_file.h"
 #include "gn/rust_substitution_type.h"
 #include "gn/scheduler.h"
+#include "gn/settings.h"
 #include "gn/string_output_buffer.h"
 #include "gn/string_utils.h"
 #include "gn/substitution_writer.h"
 #include "gn/target.h"
 #include "gn/trace.h"
 
+namespace {
+
+// Helpers to build flag block keys. Lists and strings are prefixed with their
+// size so that adjacent values can't be confused.
+void AppendToFlagBlockKey(size_t value, std::string* key) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendToFlagBlockKey(std::string_view value, std::string* key) {
+  AppendToFlagBlockKey(value.size(), key);
+  key->append(value);
+}
+
+// Computes the FlagBlockCache key of the flags written by
+// WriteCCompilerFlags() for the given target. Returns false if the flags
+// can't be shared with other targets.
+bool GetCCompilerFlagsKey(const Target* target,
+                          bool indent,
+                          bool respect_source_used,
+                          std::string* key) {
+  const ConfigValues& values = target->config_values();
+
+  // The precompiled header flags name files specific to the target.
+  if (values.has_precompiled_headers())
+    return false;
+
+  key->push_back(indent);
+  key->push_back(respect_source_used);
+  for (int i = 0; i < SourceFile::SOURCE_NUMTYPES; i++) {
+    key->push_back(
+        target->source_types_used().Get(static_cast<SourceFile::Type>(i)));
+  }
+
+  // Configs are identified by their address, their values are final.
+  AppendToFlagBlockKey(target->configs().size(), key);
+  for (const LabelConfigPair& pair : target->configs()) {
+    const Config* config = pair.ptr;
+    key->append(reinterpret_cast<const char*>(&config), sizeof(config));
+  }
+
+  for (const std::vector<SourceDir>* dirs :
+       {&values.framework_dirs(), &values.include_dirs()}) {
+    AppendToFlagBlockKey(dirs->size(), key);
+    for (const SourceDir& dir : *dirs)
+      AppendToFlagBlockKey(dir.value(), key);
+  }
+  for (const std::vector<std::string>* strings :
+       {&values.defines(), &values.asmflags(), &values.cflags(),
+        &values.cflags_c(), &values.cflags_cc(), &values.cflags_objc(),
+        &values.cflags_objcc()}) {
+    AppendToFlagBlockKey(strings->size(), key);
+    for (const std::string& string : *strings)
+      AppendToFlagBlockKey(string, key);
+  }
+  return true;
+}
+
+// Replaces the non-empty values of the "name = value" lines of a flag block
+// with references to variables shared in the toolchain's Ninja file.
+std::string ShareFlagValues(std::string_view block, FlagBlockCache* cache) {
+  std::string result;
+  while (!block.empty()) {
+    size_t line_end = block.find('\n');
+    std::string_view line = block.substr(0, line_end);
+    size_t equals = line.find(" = ");
+    if (equals == std::string_view::npos) {
+      result.append(line);
+    } else {
+      result.append(line.substr(0, equals));
+      result.append(" = $");
+      result.append(cache->GetSharedVariable(line.substr(equals + 3)));
+    }
+    result.push_back('\n');
+    if (line_end == std::string_view::npos)
+      break;
+    block.remove_prefix(line_end + 1);
+  }
+  return result;
+}
+
+using FileVariables = std::vector<std::pair<std::string_view, std::string_view>>;
+
+// Appends the Ninja |value| with the references to the given file-level
+// variables replaced by their values.
+void AppendWithFileVariablesExpanded(std::string_view value,
+                                     const FileVariables& variables,
+                                     std::string* out) {
+  auto is_name_char = [](char c, bool braces) {
+    return base::IsAsciiAlpha(c) || base::IsAsciiDigit(c) || c == '_' ||
+           c == '-' || (braces && c == '.');
+  };
+  size_t i = 0;
+  while (i < value.size()) {
+    size_t dollar = value.find('$', i);
+    if (dollar == std::string_view::npos || dollar + 1 == value.size()) {
+      out->append(value.substr(i));
+      return;
+    }
+    out->append(value.substr(i, dollar - i));
+
+    // Finds the name of a "$name" or "${name}" reference.
+    bool braces = value[dollar + 1] == '{';
+    size_t name_begin = dollar + (braces ? 2 : 1);
+    size_t name_end = name_begin;
+    while (name_end < value.size() && is_name_char(value[name_end], braces))
+      name_end++;
+    size_t reference_end = name_end;
+    if (braces) {
+      if (name_end == value.size() || value[name_end] != '}')
+        name_end = name_begin;  // Not a valid reference.
+      else
+        reference_end++;
+    }
+    if (name_end == name_begin) {
+      // An escape such as "$$" or "$ ", copied as is.
+      out->append(value.substr(dollar, 2));
+      i = dollar + 2;
+      continue;
+    }
+
+    std::string_view name = value.substr(name_begin, name_end - name_begin);
+    auto found = std::find_if(
+        variables.begin(), variables.end(),
+        [name](const auto& variable) { return variable.first == name; });
+    if (found == variables.end())
+      out->append(value.substr(dollar, reference_end - dollar));
+    else
+      out->append(found->second);
+    i = reference_end;
+  }
+}
+
+// Rewrites the rules of a binary target so that they can share a Ninja file
+// with the rules of other targets. The file-level variables of the target
+// (cflags, defines, etc.) would leak into the other targets, so they are
+// bound on each build statement instead.
+//
+// Ninja evaluates the bindings of a build statement in the scope of the file,
+// so the references of the target's own bindings to file-level variables, like
+// "cflags_cc = ${cflags_cc} /Yc..." for MSVC precompiled headers, are replaced
+// by the values, which the shard file doesn't define.
+std::string BindFileVariablesToBuildStatements(std::string_view rules) {
+  std::vector<std::string_view> lines;
+  while (!rules.empty()) {
+    size_t line_end = rules.find('\n');
+    lines.push_back(rules.substr(0, line_end));
+    if (line_end == std::string_view::npos)
+      break;
+    rules.remove_prefix(line_end + 1);
+  }
+
+  // Ninja uses the last value of a file-level variable for all the build
+  // statements of the file, so collect them first.
+  FileVariables variables;
+  for (std::string_view line : lines) {
+    if (line.empty() || line[0] == ' ' || line.substr(0, 6) == "build ")
+      continue;
+    size_t equals = line.find(" =");
+    std::string_view name = line.substr(0, equals);
+    std::string_view value;
+    if (equals != std::string_view::npos)
+      value = line.substr(std::min(equals + 3, line.size()));
+    auto found = std::find_if(
+        variables.begin(), variables.end(),
+        [name](const auto& variable) { return variable.first == name; });
+    if (found == variables.end())
+      variables.emplace_back(name, value);
+    else
+      found->second = value;
+  }
+
+  // The variables come first so that the bindings of the build statement
+  // itself override them.
+  std::string result;
+  for (std::string_view line : lines) {
+    if (line.empty()) {
+      // Nothing to add.
+    } else if (line[0] == ' ') {
+      AppendWithFileVariablesExpanded(line, variables, &result);
+    } else if (line.substr(0, 6) == "build ") {
+      result.append(line);
+      for (const auto& variable : variables) {
+        result.append("\n  ");
+        result.append(variable.first);
+        result.append(" =");
+        if (!variable.second.empty()) {
+          result.push_back(' ');
+          result.append(variable.second);
+        }
+      }
+    } else {
+      continue;
+    }
+    result.push_back('\n');
+  }
+  return result;
+}
+
+}  // namespace
+
 NinjaTargetWriter::NinjaTargetWriter(const Target* target, std::ostream& out)
     : settings_(target->settings()),
       target_(target),
@@ -99,7 +307,8 @@ void NinjaTargetWriter::WriteOutputs(std::vector<OutputFile>&& outputs) const {
 std::string NinjaTargetWriter::RunAndWriteFile(
     const Target* target,
     ResolvedTargetData* resolved,
-    std::vector<OutputFile>* ninja_outputs) {
+    std::vector<OutputFile>* ninja_outputs,
+    FileWriteQueue* write_queue) {
   const Settings* settings = target->settings();
 
   ScopedTrace trace(TraceItem::TRACE_FILE_WRITE_NINJA,
@@ -171,12 +380,22 @@ std::string NinjaTargetWriter::RunAndWriteFile(
     CHECK(0) << "Output type of target not handled.";
   }
 
+  if (needs_file_write &&
+      settings->build_settings()->ninja_target_shards() > 0) {
+    // The rules will be written to a shard file of the toolchain with the
+    // rules of other targets, see NinjaToolchainWriter.
+    return BindFileVariablesToBuildStatements(storage.str());
+  }
+
   if (needs_file_write) {
     // Write the ninja file.
     SourceFile ninja_file = GetNinjaFileForTarget(target);
     base::FilePath full_ninja_file =
         settings->build_settings()->GetFullPath(ninja_file);
-    storage.WriteToFileIfChanged(full_ninja_file, nullptr);
+    if (write_queue)
+      write_queue->WriteFileIfChanged(full_ninja_file, storage.str());
+    else
+      storage.WriteToFileIfChanged(full_ninja_file, nullptr);
 
     EscapeOptions options;
     options.mode = ESCAPE_NINJA;
@@ -264,15 +483,96 @@ void NinjaTargetWriter::WriteSharedVars(const SubstitutionBits& bits) {
 void NinjaTargetWriter::WriteCCompilerVars(const SubstitutionBits& bits,
                                            bool indent,
                                            bool respect_source_used) {
+  // With the toolchain's substitutions, the compiler flags only depend on the
+  // configs and the values of the target, which most targets share. Render
+  // them once per distinct set and reuse the text.
+  std::string key;
+  if (&bits == &target_->toolchain()->substitution_bits() &&
+      GetCCompilerFlagsKey(target_, indent, respect_source_used, &key)) {
+    FlagBlockCache& cache = settings_->flag_block_cache();
+    const std::string* block = cache.Find(key);
+    if (!block) {
+      std::ostringstream block_out;
+      WriteCCompilerFlags(bits, indent, respect_source_used, block_out);
+      if (settings_->build_settings()->ninja_shared_flag_sets()) {
+        block = &cache.Insert(std::move(key),
+                              ShareFlagValues(block_out.str(), &cache));
+      } else {
+        block = &cache.Insert(std::move(key), block_out.str());
+      }
+    }
+    out_ << *block;
+  } else {
+    WriteCCompilerFlags(bits, indent, respect_source_used, out_);
+  }
+
+  EscapeOptions opts;
+  opts.mode = ESCAPE_NINJA_COMMAND;
+  if (target_->source_types_used().SwiftSourceUsed() || !respect_source_used) {
+    if (bits.used.count(&CSubstitutionSwiftModuleName)) {
+      if (indent)
+        out_ << "  ";
+      out_ << CSubstitutionSwiftModuleName.ninja_name << " = ";
+      EscapeStringToStream(out_, target_->swift_values().module_name(), opts);
+      out_ << std::endl;
+    }
+
+    if (bits.used.count(&CSubstitutionSwiftBridgeHeader)) {
+      if (indent)
+        out_ << "  ";
+      out_ << CSubstitutionSwiftBridgeHeader.ninja_name << " = ";
+      if (!target_->swift_values().bridge_header().is_null()) {
+        path_output_.WriteFile(out_, target_->swift_values().bridge_header());
+      } else {
+        out_ << R"("")";
+      }
+      out_ << std::endl;
+    }
+
+    if (bits.used.count(&CSubstitutionSwiftModuleDirs)) {
+      // Uniquify the list of swiftmodule dirs (in case multiple swiftmodules
+      // are generated in the same directory).
+      UniqueVector<SourceDir> swiftmodule_dirs;
+      for (const Target* dep : resolved().GetSwiftModuleDependencies(target_))
+        swiftmodule_dirs.push_back(dep->swift_values().module_output_dir());
+
+      if (indent)
+        out_ << "  ";
+      out_ << CSubstitutionSwiftModuleDirs.ninja_name << " =";
+      PathOutput swiftmodule_path_output(path_output_, ESCAPE_NINJA_COMMAND);
+      IncludeWriter swiftmodule_path_writer(swiftmodule_path_output);
+      for (const SourceDir& swiftmodule_dir : swiftmodule_dirs) {
+        swiftmodule_path_writer(swiftmodule_dir, out_);
+      }
+      out_ << std::endl;
+    }
+
+    WriteOneFlag(kRecursiveWriterKeepDuplicates, target_,
+                 &CSubstitutionSwiftFlags, false, CTool::kCToolSwift,
+                 &ConfigValues::swiftflags, opts, path_output_, out_, true,
+                 indent);
+  }
+}
+
+void NinjaTargetWriter::WriteCCompilerFlags(const SubstitutionBits& bits,
+                                            bool indent,
+                                            bool respect_source_used,
+                                            std::ostream& out) {
+  bool has_precompiled_headers =
+      target_->config_values().has_precompiled_headers();
+
+  EscapeOptions opts;
+  opts.mode = ESCAPE_NINJA_COMMAND;
+
   // Defines.
   if (bits.used.count(&CSubstitutionDefines)) {
     if (indent)
-      out_ << "  ";
-    out_ << CSubstitutionDefines.ninja_name << " =";
+      out << "  ";
+    out << CSubstitutionDefines.ninja_name << " =";
     RecursiveTargetConfigToStream<std::string>(kRecursiveWriterSkipDuplicates,
                                                target_, &ConfigValues::defines,
-                                               DefineWriter(), out_);
-    out_ << std::endl;
+                                               DefineWriter(), out);
+    out << std::endl;
   }
 
   // Framework search path.
@@ -280,44 +580,35 @@ void NinjaTargetWriter::WriteCCompilerVars(const SubstitutionBits& bits,
     const Tool* tool = target_->toolchain()->GetTool(CTool::kCToolLink);
 
     if (indent)
-      out_ << "  ";
-    out_ << CSubstitutionFrameworkDirs.ninja_name << " =";
-    PathOutput framework_dirs_output(
-        path_output_.current_dir(),
-        settings_->build_settings()->root_path_utf8(), ESCAPE_NINJA_COMMAND);
+      out << "  ";
+    out << CSubstitutionFrameworkDirs.ninja_name << " =";
+    PathOutput framework_dirs_output(path_output_, ESCAPE_NINJA_COMMAND);
     RecursiveTargetConfigToStream<SourceDir>(
         kRecursiveWriterSkipDuplicates, target_, &ConfigValues::framework_dirs,
         FrameworkDirsWriter(framework_dirs_output,
                             tool->framework_dir_switch()),
-        out_);
-    out_ << std::endl;
+        out);
+    out << std::endl;
   }
 
   // Include directories.
   if (bits.used.count(&CSubstitutionIncludeDirs)) {
     if (indent)
-      out_ << "  ";
-    out_ << CSubstitutionIncludeDirs.ninja_name << " =";
-    PathOutput include_path_output(
-        path_output_.current_dir(),
-        settings_->build_settings()->root_path_utf8(), ESCAPE_NINJA_COMMAND);
+      out << "  ";
+    out << CSubstitutionIncludeDirs.ninja_name << " =";
+    PathOutput include_path_output(path_output_, ESCAPE_NINJA_COMMAND);
     RecursiveTargetConfigToStream<SourceDir>(
         kRecursiveWriterSkipDuplicates, target_, &ConfigValues::include_dirs,
-        IncludeWriter(include_path_output), out_);
-    out_ << std::endl;
+        IncludeWriter(include_path_output), out);
+    out << std::endl;
   }
 
-  bool has_precompiled_headers =
-      target_->config_values().has_precompiled_headers();
-
-  EscapeOptions opts;
-  opts.mode = ESCAPE_NINJA_COMMAND;
   if (respect_source_used
           ? target_->source_types_used().Get(SourceFile::SOURCE_S)
           : bits.used.count(&CSubstitutionAsmFlags)) {
     WriteOneFlag(kRecursiveWriterKeepDuplicates, target_,
                  &CSubstitutionAsmFlags, false, Tool::kToolNone,
-                 &ConfigValues::asmflags, opts, path_output_, out_, true,
+                 &ConfigValues::asmflags, opts, path_output_, out, true,
                  indent);
   }
   if (respect_source_used
@@ -329,14 +620,14 @@ void NinjaTargetWriter::WriteCCompilerVars(const SubstitutionBits& bits,
           : bits.used.count(&CSubstitutionCFlags)) {
     WriteOneFlag(kRecursiveWriterKeepDuplicates, target_, &CSubstitutionCFlags,
                  false, Tool::kToolNone, &ConfigValues::cflags, opts,
-                 path_output_, out_, true, indent);
+                 path_output_, out, true, indent);
   }
   if (respect_source_used
           ? target_->source_types_used().Get(SourceFile::SOURCE_C)
           : bits.used.count(&CSubstitutionCFlagsC)) {
     WriteOneFlag(kRecursiveWriterKeepDuplicates, target_, &CSubstitutionCFlagsC,
                  has_precompiled_headers, CTool::kCToolCc,
-                 &ConfigValues::cflags_c, opts, path_output_, out_, true,
+                 &ConfigValues::cflags_c, opts, path_output_, out, true,
                  indent);
   }
   if (respect_source_used
@@ -346,7 +637,7 @@ void NinjaTargetWriter::WriteCCompilerVars(const SubstitutionBits& bits,
     WriteOneFlag(kRecursiveWriterKeepDuplicates, target_,
                  &CSubstitutionCFlagsCc, has_precompiled_headers,
                  CTool::kCToolCxx, &ConfigValues::cflags_cc, opts, path_output_,
-                 out_, true, indent);
+                 out, true, indent);
   }
   if (respect_source_used
           ? target_->source_types_used().Get(SourceFile::SOURCE_M)
@@ -354,7 +645,7 @@ void NinjaTargetWriter::WriteCCompilerVars(const SubstitutionBits& bits,
     WriteOneFlag(kRecursiveWriterKeepDuplicates, target_,
                  &CSubstitutionCFlagsObjC, has_precompiled_headers,
                  CTool::kCToolObjC, &ConfigValues::cflags_objc, opts,
-                 path_output_, out_, true, indent);
+                 path_output_, out, true, indent);
   }
   if (respect_source_used
           ? target_->source_types_used().Get(SourceFile::SOURCE_MM)
@@ -362,53 +653,7 @@ void NinjaTargetWriter::WriteCCompilerVars(const SubstitutionBits& bits,
     WriteOneFlag(kRecursiveWriterKeepDuplicates, target_,
                  &CSubstitutionCFlagsObjCc, has_precompiled_headers,
                  CTool::kCToolObjCxx, &ConfigValues::cflags_objcc, opts,
-                 path_output_, out_, true, indent);
-  }
-  if (target_->source_types_used().SwiftSourceUsed() || !respect_source_used) {
-    if (bits.used.count(&CSubstitutionSwiftModuleName)) {
-      if (indent)
-        out_ << "  ";
-      out_ << CSubstitutionSwiftModuleName.ninja_name << " = ";
-      EscapeStringToStream(out_, target_->swift_values().module_name(), opts);
-      out_ << std::endl;
-    }
-
-    if (bits.used.count(&CSubstitutionSwiftBridgeHeader)) {
-      if (indent)
-        out_ << "  ";
-      out_ << CSubstitutionSwiftBridgeHeader.ninja_name << " = ";
-      if (!target_->swift_values().bridge_header().is_null()) {
-        path_output_.WriteFile(out_, target_->swift_values().bridge_header());
-      } else {
-        out_ << R"("")";
-      }
-      out_ << std::endl;
-    }
-
-    if (bits.used.count(&CSubstitutionSwiftModuleDirs)) {
-      // Uniquify the list of swiftmodule dirs (in case multiple swiftmodules
-      // are generated in the same directory).
-      UniqueVector<SourceDir> swiftmodule_dirs;
-      for (const Target* dep : resolved().GetSwiftModuleDependencies(target_))
-        swiftmodule_dirs.push_back(dep->swift_values().module_output_dir());
-
-      if (indent)
-        out_ << "  ";
-      out_ << CSubstitutionSwiftModuleDirs.ninja_name << " =";
-      PathOutput swiftmodule_path_output(
-          path_output_.current_dir(),
-          settings_->build_settings()->root_path_utf8(), ESCAPE_NINJA_COMMAND);
-      IncludeWriter swiftmodule_path_writer(swiftmodule_path_output);
-      for (const SourceDir& swiftmodule_dir : swiftmodule_dirs) {
-        swiftmodule_path_writer(swiftmodule_dir, out_);
-      }
-      out_ << std::endl;
-    }
-
-    WriteOneFlag(kRecursiveWriterKeepDuplicates, target_,
-                 &CSubstitutionSwiftFlags, false, CTool::kCToolSwift,
-                 &ConfigValues::swiftflags, opts, path_output_, out_, true,
-                 indent);
+                 path_output_, out, true, indent);
   }
 }
 
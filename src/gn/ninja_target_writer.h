@@ -11,6 +11,7 @@
 #include "gn/resolved_target_data.h"
 #include "gn/substitution_type.h"
 
+class FileWriteQueue;
 class OutputFile;
 class Settings;
 class Target;
@@ -49,10 +50,14 @@ class NinjaTargetWriter {
   //
   // If |ninja_outputs| is not nullptr, it will be set with the list of
   // Ninja output paths generated by the corresponding writer.
+  //
+  // If |write_queue| is not nullptr, the separate ninja file is queued there
+  // instead of being written before returning.
   static std::string RunAndWriteFile(
       const Target* target,
       ResolvedTargetData* resolved = nullptr,
-      std::vector<OutputFile>* ninja_outputs = nullptr);
+      std::vector<OutputFile>* ninja_outputs = nullptr,
+      FileWriteQueue* write_queue = nullptr);
 
   virtual void Run() = 0;
 
@@ -75,6 +80,14 @@ class NinjaTargetWriter {
                           bool indent,
                           bool respect_source_used);
 
+  // Writes the part of WriteCCompilerVars() that only depends on the configs
+  // and values of the target (defines, include dirs and flags) to the given
+  // stream.
+  void WriteCCompilerFlags(const SubstitutionBits& bits,
+                           bool indent,
+                           bool respect_source_used,
+                           std::ostream& out);
+
   // Writes out the substitution values that are shared between Rust tools
   // and action tools. Only the substitutions identified by the given bits will
   // be written, unless 'always_write' is specified.
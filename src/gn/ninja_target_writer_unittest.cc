@@ -2,11 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <memory>
 #include <sstream>
+#include <utility>
 
+#include "gn/c_tool.h"
 #include "gn/ninja_action_target_writer.h"
 #include "gn/ninja_target_writer.h"
+#include "gn/substitution_list.h"
 #include "gn/target.h"
+#include "gn/test_with_scheduler.h"
 #include "gn/test_with_scope.h"
 #include "util/test/test.h"
 
@@ -300,3 +305,99 @@ TEST(NinjaTargetWriter, WriteInputDepsStampOrPhonyAndGetDepWithToolchainDeps) {
   EXPECT_EQ("phony/foo/setup", dep[0].value());
   EXPECT_EQ("", stream.str());
 }
+
+using NinjaTargetWriterTest = TestWithScheduler;
+
+// With ninja_target_shards, the rules of binary targets are returned with the
+// file-level variables bound on each build statement.
+TEST_F(NinjaTargetWriterTest, RunAndWriteFileSharded) {
+  TestWithScope setup;
+  setup.build_settings()->set_ninja_target_shards(4);
+  Err err;
+
+  TestTarget target(setup, "//foo:bar", Target::SOURCE_SET);
+  target.sources().push_back(SourceFile("//foo/input1.cc"));
+  target.source_types_used().Set(SourceFile::SOURCE_CPP);
+  target.config_values().cflags().push_back("-Wall");
+  ASSERT_TRUE(target.OnResolved(&err));
+
+  const char kVariables[] =
+      "  defines =\n"
+      "  include_dirs =\n"
+      "  cflags = -Wall\n"
+      "  cflags_cc =\n"
+      "  root_out_dir = .\n"
+      "  target_gen_dir = gen/foo\n"
+      "  target_out_dir = obj/foo\n"
+      "  target_output_name = bar\n";
+  std::string expected =
+      "\n"
+      "build obj/foo/bar.input1.o: cxx ../../foo/input1.cc\n";
+  expected += kVariables;
+  expected +=
+      "  source_file_part = input1.cc\n"
+      "  source_name_part = input1\n"
+      "\n"
+      "build phony/foo/bar: phony obj/foo/bar.input1.o\n";
+  expected += kVariables;
+  std::string rules =
+      NinjaTargetWriter::RunAndWriteFile(&target, nullptr, nullptr);
+  EXPECT_EQ(expected, rules) << rules;
+}
+
+// The bindings of build statements referring to file-level variables, like the
+// ones of MSVC precompiled headers, are expanded since the shard file doesn't
+// define the variables.
+TEST_F(NinjaTargetWriterTest, RunAndWriteFileShardedWinPrecompiledHeaders) {
+  TestWithScope setup;
+  setup.build_settings()->set_ninja_target_shards(1);
+  Err err;
+
+  Settings pch_settings(setup.build_settings(), "withpch/");
+  Toolchain pch_toolchain(&pch_settings,
+                          Label(SourceDir("//toolchain/"), "withpch"));
+  pch_settings.set_toolchain_label(pch_toolchain.label());
+  pch_settings.set_default_toolchain_label(setup.toolchain()->label());
+  std::unique_ptr<Tool> cxx = std::make_unique<CTool>(CTool::kCToolCxx);
+  CTool* cxx_tool = cxx->AsC();
+  TestWithScope::SetCommandForTool(
+      "c++ {{source}} {{cflags}} {{cflags_cc}} {{defines}} -o {{output}}",
+      cxx_tool);
+  cxx_tool->set_outputs(SubstitutionList::MakeForTest(
+      "{{source_out_dir}}/{{target_output_name}}.{{source_name_part}}.o"));
+  cxx_tool->set_precompiled_header_type(CTool::PCH_MSVC);
+  pch_toolchain.SetTool(std::move(cxx));
+  pch_toolchain.ToolchainSetupComplete();
+
+  Target target(&pch_settings, Label(SourceDir("//foo/"), "pch_target"));
+  target.config_values().set_precompiled_header("build/precompile.h");
+  target.config_values().set_precompiled_source(
+      SourceFile("//build/precompile.cc"));
+  target.config_values().cflags_cc().push_back("/O2");
+  target.config_values().defines().push_back("FOO");
+  target.set_output_type(Target::SOURCE_SET);
+  target.visibility().SetPublic();
+  target.sources().push_back(SourceFile("//foo/input1.cc"));
+  target.source_types_used().Set(SourceFile::SOURCE_CPP);
+  target.SetToolchain(&pch_toolchain);
+  ASSERT_TRUE(target.OnResolved(&err));
+
+  std::string rules =
+      NinjaTargetWriter::RunAndWriteFile(&target, nullptr, nullptr);
+  EXPECT_NE(std::string::npos,
+            rules.find("build withpch/obj/build/pch_target.precompile.cc.o: "
+                       "withpch_cxx ../../build/precompile.cc\n"
+                       "  defines = -DFOO\n"))
+      << rules;
+  EXPECT_NE(std::string::npos,
+            rules.find("  cflags_cc = /Fpwithpch/obj/foo/pch_target_cc.pch "
+                       "/Yubuild/precompile.h /O2\n"))
+      << rules;
+  EXPECT_NE(std::string::npos,
+            rules.find("  source_file_part = precompile.cc\n"
+                       "  source_name_part = precompile\n"
+                       "  cflags_cc = /Fpwithpch/obj/foo/pch_target_cc.pch "
+                       "/Yubuild/precompile.h /O2 /Ycbuild/precompile.h\n"))
+      << rules;
+  EXPECT_EQ(std::string::npos, rules.find("${cflags_cc}")) << rules;
+}
@@ -5,12 +5,16 @@
 #include "gn/ninja_toolchain_writer.h"
 
 #include <fstream>
+#include <utility>
 
 #include "base/files/file_util.h"
+#include "base/hash.h"
 #include "base/strings/stringize_macros.h"
 #include "gn/build_settings.h"
 #include "gn/builtin_tool.h"
 #include "gn/c_tool.h"
+#include "gn/escape.h"
+#include "gn/file_write_queue.h"
 #include "gn/filesystem_utils.h"
 #include "gn/general_tool.h"
 #include "gn/ninja_utils.h"
@@ -52,6 +56,16 @@ void NinjaToolchainWriter::Run(
   }
   out_ << std::endl;
 
+  // The flag values shared by the targets must be defined before the targets'
+  // Ninja files are loaded.
+  std::vector<std::pair<std::string, std::string>> shared_flags =
+      settings_->flag_block_cache().GetSharedVariables();
+  if (!shared_flags.empty()) {
+    for (const auto& [name, value] : shared_flags)
+      out_ << name << " = " << value << std::endl;
+    out_ << std::endl;
+  }
+
   for (const auto& pair : rules)
     out_ << pair.second;
 }
@@ -75,10 +89,63 @@ bool NinjaToolchainWriter::RunAndWriteFile(
     return false;
 
   NinjaToolchainWriter gen(settings, toolchain, file);
-  gen.Run(rules);
+  if (settings->build_settings()->ninja_target_shards() > 0) {
+    std::vector<NinjaWriter::TargetRulePair> toolchain_rules;
+    if (!WriteShards(settings, rules, &toolchain_rules))
+      return false;
+    gen.Run(toolchain_rules);
+  } else {
+    gen.Run(rules);
+  }
   return true;
 }
 
+// static
+bool NinjaToolchainWriter::WriteShards(
+    const Settings* settings,
+    const std::vector<NinjaWriter::TargetRulePair>& rules,
+    std::vector<NinjaWriter::TargetRulePair>* toolchain_rules) {
+  // Binary targets go to the shard picked by their label, so adding or
+  // removing a target only changes one shard. Label::hash() depends on the
+  // addresses of the interned strings, so hash the label's text to get the
+  // same shards on each run. The rules of the other targets are written to
+  // the toolchain file as usual.
+  std::vector<std::string> shards(
+      settings->build_settings()->ninja_target_shards());
+  for (const auto& pair : rules) {
+    if (pair.first && pair.first->IsBinary()) {
+      size_t shard =
+          base::FastHash64(pair.first->label().GetUserVisibleName(false)) %
+          shards.size();
+      shards[shard].append(pair.second);
+    } else {
+      toolchain_rules->push_back(pair);
+    }
+  }
+
+  EscapeOptions options;
+  options.mode = ESCAPE_NINJA;
+  FileWriteQueue write_queue;
+  for (size_t i = 0; i < shards.size(); i++) {
+    if (shards[i].empty())
+      continue;
+
+    SourceFile shard_file =
+        GetNinjaShardFileForToolchain(settings, static_cast<int>(i));
+    base::FilePath full_shard_file =
+        settings->build_settings()->GetFullPath(shard_file);
+    write_queue.WriteFileIfChanged(full_shard_file, std::move(shards[i]));
+
+    std::string subninja = "subninja ";
+    subninja.append(EscapeString(
+        OutputFile(settings->build_settings(), shard_file).value(), options,
+        nullptr));
+    subninja.push_back('\n');
+    toolchain_rules->emplace_back(nullptr, std::move(subninja));
+  }
+  return write_queue.Wait(nullptr);
+}
+
 void NinjaToolchainWriter::WriteToolRule(Tool* tool,
                                          const std::string& rule_prefix) {
   out_ << "rule " << rule_prefix << tool->name() << std::endl;
@@ -31,6 +31,8 @@ class NinjaToolchainWriter {
  private:
   FRIEND_TEST_ALL_PREFIXES(NinjaToolchainWriter, WriteToolRule);
   FRIEND_TEST_ALL_PREFIXES(NinjaToolchainWriter, WriteToolRuleWithLauncher);
+  FRIEND_TEST_ALL_PREFIXES(NinjaToolchainWriter, SharedFlagSets);
+  FRIEND_TEST_ALL_PREFIXES(NinjaToolchainWriter, WriteShards);
 
   NinjaToolchainWriter(const Settings* settings,
                        const Toolchain* toolchain,
@@ -39,6 +41,14 @@ class NinjaToolchainWriter {
 
   void Run(const std::vector<NinjaWriter::TargetRulePair>& extra_rules);
 
+  // Writes the rules of the binary targets to the shard files of the
+  // toolchain when ninja_target_shards is set. The other rules and the
+  // subninja statements loading the shards are added to toolchain_rules.
+  static bool WriteShards(
+      const Settings* settings,
+      const std::vector<NinjaWriter::TargetRulePair>& rules,
+      std::vector<NinjaWriter::TargetRulePair>* toolchain_rules);
+
   void WriteRules();
   void WriteToolRule(Tool* tool, const std::string& rule_prefix);
   void WriteRulePattern(const char* name,
@@ -4,7 +4,11 @@
 
 #include <sstream>
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/filesystem_utils.h"
 #include "gn/ninja_toolchain_writer.h"
+#include "gn/target.h"
 #include "gn/test_with_scope.h"
 #include "util/test/test.h"
 
@@ -38,3 +42,55 @@ TEST(NinjaToolchainWriter, WriteToolRuleWithLauncher) {
       "-o ${out}\n",
       stream.str());
 }
+
+TEST(NinjaToolchainWriter, SharedFlagSets) {
+  TestWithScope setup;
+  std::string name =
+      setup.settings()->flag_block_cache().GetSharedVariable("-Wall");
+
+  std::ostringstream stream;
+  NinjaToolchainWriter writer(setup.settings(), setup.toolchain(), stream);
+  writer.Run({{nullptr, "subninja obj/foo/bar.ninja\n"}});
+
+  // The shared variables come before the targets' Ninja files.
+  std::string out = stream.str();
+  size_t variable = out.find("\n" + name + " = -Wall\n\n");
+  ASSERT_NE(std::string::npos, variable);
+  EXPECT_LT(variable, out.find("subninja obj/foo/bar.ninja\n"));
+}
+
+TEST(NinjaToolchainWriter, WriteShards) {
+  TestWithScope setup;
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  setup.build_settings()->SetRootPath(temp_dir.GetPath());
+  setup.build_settings()->SetBuildDir(SourceDir("//out/"));
+  setup.build_settings()->set_ninja_target_shards(1);
+  ASSERT_TRUE(base::CreateDirectory(temp_dir.GetPath().AppendASCII("out")));
+
+  TestTarget first(setup, "//foo:first", Target::SOURCE_SET);
+  TestTarget second(setup, "//foo:second", Target::EXECUTABLE);
+  TestTarget group(setup, "//foo:group", Target::GROUP);
+  std::vector<NinjaWriter::TargetRulePair> rules = {
+      {&first, "build first\n"},
+      {&group, "build group: phony\n"},
+      {&second, "build second\n"}};
+
+  // Binary targets are moved to the shard, the others stay in the toolchain
+  // file which loads the shard.
+  std::vector<NinjaWriter::TargetRulePair> toolchain_rules;
+  ASSERT_TRUE(
+      NinjaToolchainWriter::WriteShards(setup.settings(), rules,
+                                        &toolchain_rules));
+  std::vector<NinjaWriter::TargetRulePair> expected_rules = {
+      {&group, "build group: phony\n"},
+      {nullptr, "subninja toolchain_shard_0.ninja\n"}};
+  EXPECT_EQ(expected_rules, toolchain_rules);
+
+  std::string shard;
+  ASSERT_TRUE(base::ReadFileToString(
+      temp_dir.GetPath().AppendASCII("out").AppendASCII(
+          "toolchain_shard_0.ninja"),
+      &shard));
+  EXPECT_EQ("build first\nbuild second\n", shard);
+}
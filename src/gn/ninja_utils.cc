@@ -21,6 +21,14 @@ SourceFile GetNinjaFileForToolchain(const Settings* settings) {
                     "toolchain.ninja");
 }
 
+SourceFile GetNinjaShardFileForToolchain(const Settings* settings,
+                                         int shard) {
+  return SourceFile(GetBuildDirAsSourceDir(BuildDirContext(settings),
+                                           BuildDirType::TOOLCHAIN_ROOT)
+                        .value() +
+                    "toolchain_shard_" + std::to_string(shard) + ".ninja");
+}
+
 std::string GetNinjaRulePrefixForToolchain(const Settings* settings) {
   // Don't prefix the default toolchain so it looks prettier, prefix everything
   // else.
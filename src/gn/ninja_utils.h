@@ -18,6 +18,12 @@ SourceFile GetNinjaFileForTarget(const Target* target);
 // Returns the name of the root .ninja file for the given toolchain.
 SourceFile GetNinjaFileForToolchain(const Settings* settings);
 
+// Returns the name of the .ninja file holding the given shard of the binary
+// targets of the toolchain when ninja_target_shards is set. Example:
+// "toolchain_shard_3.ninja".
+SourceFile GetNinjaShardFileForToolchain(const Settings* settings,
+                                         int shard);
+
 // Returns the prefix applied to the Ninja rules in a given toolchain so they
 // don't collide with rules from other toolchains.
 std::string GetNinjaRulePrefixForToolchain(const Settings* settings);
@@ -9,6 +9,8 @@
 
 #include <string>
 
+#include "base/hash.h"
+
 class BuildSettings;
 class SourceDir;
 class SourceFile;
@@ -53,8 +55,7 @@ namespace std {
 template <>
 struct hash<OutputFile> {
   std::size_t operator()(const OutputFile& v) const {
-    hash<std::string> h;
-    return h(v.value());
+    return base::FastHash(v.value());
   }
 };
 
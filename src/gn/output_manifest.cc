@@ -0,0 +1,151 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/output_manifest.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/hash.h"
+#include "base/strings/string_number_conversions.h"
+#include "gn/build_settings.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "gn/source_file.h"
+
+namespace {
+
+// First line of the manifest. Bump the version when changing the format or
+// the hash function so that old manifests are ignored.
+const char kManifestHeader[] = "# gn output manifest v2";
+
+// Splits the next space-separated field off the front of |line|.
+std::string_view NextField(std::string_view* line) {
+  size_t space = line->find(' ');
+  if (space == std::string_view::npos)
+    space = line->size();
+  std::string_view field = line->substr(0, space);
+  line->remove_prefix(std::min(space + 1, line->size()));
+  return field;
+}
+
+}  // namespace
+
+OutputManifest::OutputManifest() = default;
+
+OutputManifest::~OutputManifest() = default;
+
+// static
+SourceFile OutputManifest::GetManifestFile(
+    const BuildSettings* build_settings) {
+  return SourceFile(build_settings->build_dir().value() +
+                    "gn_outputs.manifest");
+}
+
+// static
+uint64_t OutputManifest::HashContents(std::string_view data) {
+  return base::FastHash64(data);
+}
+
+bool OutputManifest::Load(const base::FilePath& file_path) {
+  previous_entries_.clear();
+
+  std::string contents;
+  if (!base::ReadFileToString(file_path, &contents))
+    return false;
+
+  size_t newline = contents.find('\n');
+  if (newline == std::string::npos ||
+      std::string_view(contents).substr(0, newline) != kManifestHeader)
+    return false;
+
+  // Each line is "<size> <last_modified> <hash> <path>", the path is last
+  // because it may contain spaces.
+  EntryMap entries;
+  std::string_view remaining = std::string_view(contents).substr(newline + 1);
+  while (!remaining.empty()) {
+    newline = remaining.find('\n');
+    if (newline == std::string_view::npos)
+      return false;
+    std::string_view line = remaining.substr(0, newline);
+    remaining.remove_prefix(newline + 1);
+
+    Entry entry;
+    if (!base::StringToInt64(NextField(&line), &entry.size) ||
+        !base::StringToUint64(NextField(&line), &entry.last_modified) ||
+        !base::StringToUint64(NextField(&line), &entry.hash) || line.empty())
+      return false;
+    entries[std::string(line)] = entry;
+  }
+  previous_entries_ = std::move(entries);
+  return true;
+}
+
+bool OutputManifest::Save(const base::FilePath& file_path, Err* err) const {
+  std::string contents(kManifestHeader);
+  contents.push_back('\n');
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    for (const auto& [path, entry] : entries_) {
+      contents.append(base::NumberToString(entry.size));
+      contents.push_back(' ');
+      contents.append(base::NumberToString(entry.last_modified));
+      contents.push_back(' ');
+      contents.append(base::NumberToString(entry.hash));
+      contents.push_back(' ');
+      contents.append(path);
+      contents.push_back('\n');
+    }
+  }
+  return WriteFile(file_path, contents, err);
+}
+
+bool OutputManifest::WriteFileIfChanged(const base::FilePath& file_path,
+                                        const std::string& data,
+                                        Err* err) {
+  std::string path = FilePathToUTF8(file_path);
+  uint64_t hash = HashContents(data);
+
+  base::File::Info info;
+  bool exists = base::GetFileInfo(file_path, &info);
+  bool unchanged;
+  bool hash_hit = false;
+  auto previous = previous_entries_.find(path);
+  if (exists && previous != previous_entries_.end() &&
+      previous->second.size == info.size &&
+      previous->second.last_modified == info.last_modified) {
+    // Nobody touched the file since the last run, so it still has the
+    // contents recorded in the manifest.
+    unchanged = static_cast<int64_t>(data.size()) == info.size &&
+                previous->second.hash == hash;
+    hash_hit = true;
+  } else {
+    unchanged = exists && ContentsEqual(file_path, data);
+  }
+
+  if (!unchanged) {
+    if (!WriteFile(file_path, data, err))
+      return false;
+    // Without the new timestamp the file can't be recorded, it will just be
+    // compared the regular way next time.
+    if (!base::GetFileInfo(file_path, &info))
+      return true;
+  }
+
+  std::lock_guard<std::mutex> guard(lock_);
+  Entry& entry = entries_[std::move(path)];
+  entry.size = info.size;
+  entry.last_modified = info.last_modified;
+  entry.hash = hash;
+  if (hash_hit)
+    hash_hits_++;
+  return true;
+}
+
+size_t OutputManifest::hash_hits() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return hash_hits_;
+}
@@ -0,0 +1,83 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_OUTPUT_MANIFEST_H_
+#define TOOLS_GN_OUTPUT_MANIFEST_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "base/files/file_path.h"
+
+class BuildSettings;
+class Err;
+class SourceFile;
+
+// Remembers the files written by the previous "gn gen" run, so that unchanged
+// files don't have to be read back to find out that they are unchanged.
+//
+// For each file the manifest records its size and modification time after
+// gn wrote it, as well as a hash of its contents. When the file on disk still
+// has the recorded size and modification time, it wasn't touched since, and
+// comparing the hash of the new contents with the recorded one is enough.
+// Otherwise the file is compared with the new contents as usual.
+//
+// Lookups in the loaded manifest and recording of the written files are
+// thread-safe. Loading and saving are not.
+class OutputManifest {
+ public:
+  OutputManifest();
+  ~OutputManifest();
+
+  // Returns the manifest file in the build directory.
+  static SourceFile GetManifestFile(const BuildSettings* build_settings);
+
+  // Returns the hash of file contents recorded in the manifest.
+  static uint64_t HashContents(std::string_view data);
+
+  // Loads the manifest written by a previous run. Returns false if the file
+  // doesn't exist or is not a valid manifest, in which case the manifest is
+  // empty and all files are compared the regular way.
+  bool Load(const base::FilePath& file_path);
+
+  // Writes the files recorded by WriteFileIfChanged() since loading to the
+  // given manifest file. Files of the previous run that were not written
+  // again are dropped.
+  bool Save(const base::FilePath& file_path, Err* err) const;
+
+  // Writes the given data to the given file if its contents differ, and
+  // records the file for the next run. Returns false and sets the error on
+  // failure.
+  bool WriteFileIfChanged(const base::FilePath& file_path,
+                          const std::string& data,
+                          Err* err);
+
+  // Number of existing files for which the recorded hash was used instead of
+  // reading them back.
+  size_t hash_hits() const;
+
+ private:
+  struct Entry {
+    int64_t size = 0;
+    uint64_t last_modified = 0;
+    uint64_t hash = 0;
+  };
+  using EntryMap = std::map<std::string, Entry>;
+
+  // Read-only after Load(), so it can be used without locking.
+  EntryMap previous_entries_;
+
+  mutable std::mutex lock_;
+  EntryMap entries_;
+  size_t hash_hits_ = 0;
+
+  OutputManifest(const OutputManifest&) = delete;
+  OutputManifest& operator=(const OutputManifest&) = delete;
+};
+
+#endif  // TOOLS_GN_OUTPUT_MANIFEST_H_
@@ -0,0 +1,84 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/output_manifest.h"
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "util/test/test.h"
+
+TEST(OutputManifest, WriteFileIfChanged) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath manifest_path = temp_dir.GetPath().AppendASCII("manifest");
+  base::FilePath foo_path = temp_dir.GetPath().AppendASCII("foo.ninja");
+  base::FilePath bar_path = temp_dir.GetPath().AppendASCII("bar baz.ninja");
+
+  // Without a previous manifest, files are written as usual.
+  Err err;
+  {
+    OutputManifest manifest;
+    EXPECT_FALSE(manifest.Load(manifest_path));
+    EXPECT_TRUE(manifest.WriteFileIfChanged(foo_path, "foo", &err));
+    EXPECT_TRUE(manifest.WriteFileIfChanged(bar_path, "bar", &err));
+    EXPECT_EQ(0u, manifest.hash_hits());
+    EXPECT_TRUE(manifest.Save(manifest_path, &err));
+  }
+  EXPECT_TRUE(ContentsEqual(foo_path, "foo"));
+  EXPECT_TRUE(ContentsEqual(bar_path, "bar"));
+
+  // Untouched files are compared using the recorded hash, including when
+  // their contents change.
+  {
+    OutputManifest manifest;
+    EXPECT_TRUE(manifest.Load(manifest_path));
+    EXPECT_TRUE(manifest.WriteFileIfChanged(foo_path, "foo", &err));
+    EXPECT_TRUE(manifest.WriteFileIfChanged(bar_path, "BAR", &err));
+    EXPECT_EQ(2u, manifest.hash_hits());
+    EXPECT_TRUE(manifest.Save(manifest_path, &err));
+  }
+  EXPECT_TRUE(ContentsEqual(foo_path, "foo"));
+  EXPECT_TRUE(ContentsEqual(bar_path, "BAR"));
+
+  // Files modified by someone else are compared the regular way. Files not
+  // written by the last run are dropped from the manifest.
+  EXPECT_TRUE(WriteFile(foo_path, "modified", &err));
+  {
+    OutputManifest manifest;
+    EXPECT_TRUE(manifest.Load(manifest_path));
+    EXPECT_TRUE(manifest.WriteFileIfChanged(foo_path, "foo", &err));
+    EXPECT_EQ(0u, manifest.hash_hits());
+    EXPECT_TRUE(manifest.Save(manifest_path, &err));
+  }
+  EXPECT_TRUE(ContentsEqual(foo_path, "foo"));
+  {
+    OutputManifest manifest;
+    EXPECT_TRUE(manifest.Load(manifest_path));
+    EXPECT_TRUE(manifest.WriteFileIfChanged(bar_path, "BAR", &err));
+    EXPECT_EQ(0u, manifest.hash_hits());
+  }
+  EXPECT_FALSE(err.has_error());
+}
+
+TEST(OutputManifest, InvalidManifest) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath manifest_path = temp_dir.GetPath().AppendASCII("manifest");
+
+  Err err;
+  OutputManifest manifest;
+  EXPECT_TRUE(WriteFile(manifest_path, "# gn output manifest v1\n", &err));
+  EXPECT_FALSE(manifest.Load(manifest_path));
+  EXPECT_TRUE(WriteFile(manifest_path, "# gn output manifest v2\n", &err));
+  EXPECT_TRUE(manifest.Load(manifest_path));
+  EXPECT_TRUE(WriteFile(manifest_path,
+                        "# gn output manifest v2\n3 x 12 /out/foo.ninja\n",
+                        &err));
+  EXPECT_FALSE(manifest.Load(manifest_path));
+  EXPECT_TRUE(WriteFile(manifest_path,
+                        "# gn output manifest v2\n3 4 12 /out/foo.ninja", &err));
+  EXPECT_FALSE(manifest.Load(manifest_path));
+}
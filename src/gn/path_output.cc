@@ -4,24 +4,59 @@
 
 #include "gn/path_output.h"
 
+#include <string.h>
+
 #include "base/strings/string_util.h"
 #include "gn/filesystem_utils.h"
 #include "gn/output_file.h"
 #include "gn/string_utils.h"
 #include "util/build_config.h"
 
+namespace {
+
+// Paths up to this size are assembled on the stack when they need to be
+// escaped as a whole.
+constexpr size_t kStackPathSize = 512;
+
+}  // namespace
+
 PathOutput::PathOutput(const SourceDir& current_dir,
                        std::string_view source_root,
                        EscapingMode escaping)
     : current_dir_(current_dir) {
+  options_.mode = escaping;
   inverse_current_dir_ = RebasePath("//", current_dir, source_root);
   if (!EndsWithSlash(inverse_current_dir_))
     inverse_current_dir_.push_back('/');
+  UpdateEscapedInverseCurrentDir();
+}
+
+PathOutput::PathOutput(const PathOutput& other, EscapingMode escaping)
+    : current_dir_(other.current_dir_),
+      inverse_current_dir_(other.inverse_current_dir_) {
   options_.mode = escaping;
+  // |other| may have been given other escape flags than the defaults.
+  if (escaping == other.options_.mode &&
+      other.options_.platform == options_.platform &&
+      other.options_.inhibit_quoting == options_.inhibit_quoting) {
+    escaped_inverse_current_dir_ = other.escaped_inverse_current_dir_;
+  } else {
+    UpdateEscapedInverseCurrentDir();
+  }
 }
 
 PathOutput::~PathOutput() = default;
 
+void PathOutput::set_inhibit_quoting(bool iq) {
+  options_.inhibit_quoting = iq;
+  UpdateEscapedInverseCurrentDir();
+}
+
+void PathOutput::set_escape_platform(EscapingPlatform p) {
+  options_.platform = p;
+  UpdateEscapedInverseCurrentDir();
+}
+
 void PathOutput::WriteFile(std::ostream& out, const SourceFile& file) const {
   WritePathStr(out, file.value());
 }
@@ -125,27 +160,45 @@ void PathOutput::WriteDir(std::ostream& out,
 void PathOutput::WriteFile(std::ostream& out,
                            const base::FilePath& file) const {
   // Assume native file paths are always absolute.
+#if defined(OS_WIN)
   EscapeStringToStream(out, FilePathToUTF8(file), options_);
+#else
+  EscapeStringToStream(out, file.value(), options_);
+#endif
+}
+
+void PathOutput::UpdateEscapedInverseCurrentDir() {
+  // Command escaping needs the whole path, see WriteSourceRelativeString().
+  if (options_.mode == ESCAPE_NINJA_COMMAND)
+    escaped_inverse_current_dir_.clear();
+  else
+    escaped_inverse_current_dir_ =
+        EscapeString(inverse_current_dir_, options_, nullptr);
 }
 
 void PathOutput::WriteSourceRelativeString(std::ostream& out,
                                            std::string_view str) const {
   if (options_.mode == ESCAPE_NINJA_COMMAND) {
-    // Shell escaping needs an intermediate string since it may end up
-    // quoting the whole thing.
-    std::string intermediate;
-    intermediate.reserve(inverse_current_dir_.size() + str.size());
-    intermediate.assign(inverse_current_dir_.c_str(),
-                        inverse_current_dir_.size());
-    intermediate.append(str.data(), str.size());
-
-    EscapeStringToStream(
-        out, std::string_view(intermediate.c_str(), intermediate.size()),
-        options_);
+    // Shell escaping needs the whole path at once since it may end up
+    // quoting the whole thing. Short paths are put together on the stack.
+    size_t size = inverse_current_dir_.size() + str.size();
+    if (size > kStackPathSize) {
+      std::string intermediate;
+      intermediate.reserve(size);
+      intermediate.assign(inverse_current_dir_);
+      intermediate.append(str);
+      EscapeStringToStream(out, intermediate, options_);
+      return;
+    }
+    char buffer[kStackPathSize];
+    memcpy(buffer, inverse_current_dir_.data(), inverse_current_dir_.size());
+    memcpy(buffer + inverse_current_dir_.size(), str.data(), str.size());
+    EscapeStringToStream(out, std::string_view(buffer, size), options_);
   } else {
-    // Ninja (and none) escaping can avoid the intermediate string and
-    // reprocessing of the inverse_current_dir_.
-    EscapeStringToStream(out, inverse_current_dir_, options_);
+    // Ninja (and none) escaping can avoid the intermediate string and use
+    // the inverse_current_dir_ escaped up front.
+    out.write(escaped_inverse_current_dir_.data(),
+              escaped_inverse_current_dir_.size());
     EscapeStringToStream(out, str, options_);
   }
 }
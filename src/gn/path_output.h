@@ -36,6 +36,11 @@ class PathOutput {
   PathOutput(const SourceDir& current_dir,
              std::string_view source_root,
              EscapingMode escaping);
+
+  // Writes paths relative to the same directory as |other| with the given
+  // escaping, reusing its rebased source root instead of computing it again.
+  PathOutput(const PathOutput& other, EscapingMode escaping);
+
   ~PathOutput();
 
   // Read-only since inverse_current_dir_ is computed depending on this.
@@ -45,8 +50,8 @@ class PathOutput {
 
   // Getter/setters for flags inside the escape options.
   bool inhibit_quoting() const { return options_.inhibit_quoting; }
-  void set_inhibit_quoting(bool iq) { options_.inhibit_quoting = iq; }
-  void set_escape_platform(EscapingPlatform p) { options_.platform = p; }
+  void set_inhibit_quoting(bool iq);
+  void set_escape_platform(EscapingPlatform p);
 
   void WriteFile(std::ostream& out, const SourceFile& file) const;
   void WriteFile(std::ostream& out, const OutputFile& file) const;
@@ -74,6 +79,10 @@ class PathOutput {
   void WritePathStr(std::ostream& out, std::string_view str) const;
 
  private:
+  // Escapes inverse_current_dir_ with the current options into
+  // escaped_inverse_current_dir_, when the escaping mode allows it.
+  void UpdateEscapedInverseCurrentDir();
+
   // Takes the given string and writes it out, appending to the inverse
   // current dir. This assumes leading slashes have been trimmed.
   void WriteSourceRelativeString(std::ostream& out, std::string_view str) const;
@@ -83,6 +92,10 @@ class PathOutput {
   // Uses system slashes if convert_slashes_to_system_.
   std::string inverse_current_dir_;
 
+  // The inverse_current_dir_ with the escaping applied, for escaping modes
+  // where it can be escaped separately from the rest of the path.
+  std::string escaped_inverse_current_dir_;
+
   // Since the inverse_current_dir_ depends on some of these, we don't expose
   // this directly to modification.
   EscapeOptions options_;
@@ -143,6 +143,59 @@ TEST(PathOutput, NinjaForkEscaping) {
   }
 }
 
+// The source root is escaped together with the path when it is outside of the
+// build directory.
+TEST(PathOutput, EscapedSourceRoot) {
+  SourceDir build_dir("/out/");
+  std::string_view source_root("/source root");
+  PathOutput ninja_writer(build_dir, source_root, ESCAPE_NINJA);
+  {
+    std::ostringstream out;
+    ninja_writer.WriteFile(out, SourceFile("//foo/bar.cc"));
+    EXPECT_EQ("../source$ root/foo/bar.cc", out.str());
+  }
+
+  PathOutput command_writer(ninja_writer, ESCAPE_NINJA_COMMAND);
+  EXPECT_EQ(build_dir, command_writer.current_dir());
+  command_writer.set_escape_platform(ESCAPE_PLATFORM_WIN);
+  {
+    std::ostringstream out;
+    command_writer.WriteFile(out, SourceFile("//foo/bar.cc"));
+    EXPECT_EQ("\"../source$ root/foo/bar.cc\"", out.str());
+  }
+  command_writer.set_escape_platform(ESCAPE_PLATFORM_POSIX);
+  {
+    std::ostringstream out;
+    command_writer.WriteFile(out, SourceFile("//foo/bar.cc"));
+    EXPECT_EQ("../source\\$ root/foo/bar.cc", out.str());
+  }
+  {
+    // Long paths don't fit in the stack buffer used for shell escaping.
+    std::string name(1000, 'a');
+    std::ostringstream out;
+    command_writer.WriteFile(out, SourceFile("//foo/" + name + " b.cc"));
+    EXPECT_EQ("../source\\$ root/foo/" + name + "\\$ b.cc", out.str());
+  }
+
+  PathOutput none_writer(command_writer, ESCAPE_NONE);
+  {
+    std::ostringstream out;
+    none_writer.WriteFile(out, SourceFile("//foo/bar.cc"));
+    EXPECT_EQ("../source root/foo/bar.cc", out.str());
+  }
+
+  // The escaped source root follows changes of the escape flags, and is only
+  // shared with copies using the same flags.
+  ninja_writer.set_inhibit_quoting(true);
+  ninja_writer.set_escape_platform(ESCAPE_PLATFORM_WIN);
+  PathOutput ninja_copy(ninja_writer, ESCAPE_NINJA);
+  for (const PathOutput* writer : {&ninja_writer, &ninja_copy}) {
+    std::ostringstream out;
+    writer->WriteFile(out, SourceFile("//foo/bar.cc"));
+    EXPECT_EQ("../source$ root/foo/bar.cc", out.str());
+  }
+}
+
 TEST(PathOutput, InhibitQuoting) {
   SourceDir build_dir("//out/Debug/");
   std::string_view source_root("/source/root");
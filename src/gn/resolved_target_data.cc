@@ -4,15 +4,116 @@
 
 #include "gn/resolved_target_data.h"
 
+#include <unordered_map>
+
 #include "gn/config_values_extractors.h"
 
+ResolvedTargetData::ResolvedTargetData() = default;
+
+ResolvedTargetData::~ResolvedTargetData() {
+  std::atomic<Chunk*>* chunks = chunks_.load(std::memory_order_relaxed);
+  if (!chunks)
+    return;
+  for (size_t i = 0; i < kMaxChunks; i++) {
+    Chunk* chunk = chunks[i].load(std::memory_order_relaxed);
+    if (!chunk)
+      continue;
+    for (std::atomic<TargetInfo*>& slot : *chunk)
+      delete slot.load(std::memory_order_relaxed);
+    delete chunk;
+  }
+  delete[] chunks;
+}
+
 ResolvedTargetData::TargetInfo* ResolvedTargetData::GetTargetInfo(
     const Target* target) const {
-  auto ret = targets_.PushBackWithIndex(target);
+  size_t index = target->resolved_index();
+  if (index < kChunkSize * kMaxChunks) {
+    // When two threads race to fill a slot, the loser deletes its instance
+    // and uses the winner's.
+    std::atomic<Chunk*>* chunks = chunks_.load(std::memory_order_acquire);
+    if (!chunks) {
+      std::unique_ptr<std::atomic<Chunk*>[]> new_chunks(
+          new std::atomic<Chunk*>[kMaxChunks]());
+      if (chunks_.compare_exchange_strong(chunks, new_chunks.get(),
+                                          std::memory_order_acq_rel))
+        chunks = new_chunks.release();
+    }
+
+    std::atomic<Chunk*>& chunk_slot = chunks[index / kChunkSize];
+    Chunk* chunk = chunk_slot.load(std::memory_order_acquire);
+    if (!chunk) {
+      auto new_chunk = std::make_unique<Chunk>();
+      if (chunk_slot.compare_exchange_strong(chunk, new_chunk.get(),
+                                             std::memory_order_acq_rel))
+        chunk = new_chunk.release();
+    }
+
+    std::atomic<TargetInfo*>& info_slot = (*chunk)[index % kChunkSize];
+    TargetInfo* info = info_slot.load(std::memory_order_acquire);
+    if (!info) {
+      auto new_info = std::make_unique<TargetInfo>(target);
+      if (info_slot.compare_exchange_strong(info, new_info.get(),
+                                            std::memory_order_acq_rel))
+        info = new_info.release();
+    }
+    // Indices are only unique within one Builder. Targets from another graph
+    // sharing the index use the map below.
+    if (info->target == target)
+      return info;
+  }
+
+  std::lock_guard<std::mutex> lock(unindexed_lock_);
+  auto ret = unindexed_targets_.PushBackWithIndex(target);
   if (ret.first) {
-    infos_.push_back(std::make_unique<TargetInfo>(target));
+    unindexed_infos_.push_back(std::make_unique<TargetInfo>(target));
+  }
+  return unindexed_infos_[ret.second].get();
+}
+
+struct ResolvedTargetData::PairListFlattener {
+  TargetPublicPairListBuilder result;
+
+  // For each visited node, a bit per (filter, is_public) combination it was
+  // visited with.
+  std::unordered_map<const PairListNode*, uint8_t> visited;
+};
+
+// static
+std::vector<TargetPublicPair> ResolvedTargetData::FlattenPairList(
+    const PairListNode* node) {
+  PairListFlattener flattener;
+  FlattenPairListInto(node, true, kPairListNoFilter, &flattener);
+  return flattener.result.Build();
+}
+
+// static
+void ResolvedTargetData::FlattenPairListInto(const PairListNode* node,
+                                             bool is_public,
+                                             uint8_t filter,
+                                             PairListFlattener* flattener) {
+  // Once walked with is_public set, walking it again privately adds nothing.
+  uint8_t private_bit = 1 << (filter * 2);
+  uint8_t public_bit = private_bit << 1;
+  uint8_t& visited = flattener->visited[node];
+  if (visited & (is_public ? public_bit : (private_bit | public_bit)))
+    return;
+  visited |= is_public ? public_bit : private_bit;
+
+  for (const PairListNode::Entry& entry : node->entries) {
+    bool entry_is_public = is_public && entry.is_public;
+    if (entry.node) {
+      FlattenPairListInto(entry.node, entry_is_public, filter | entry.filter,
+                          flattener);
+      continue;
+    }
+    if ((filter & kPairListSkipProcMacros) &&
+        entry.target->output_type() == Target::RUST_PROC_MACRO)
+      continue;
+    if ((filter & kPairListFinalOnly) && !entry.target->IsFinal())
+      continue;
+    flattener->result.Append(entry.target, entry_is_public);
   }
-  return infos_[ret.second].get();
 }
 
 void ResolvedTargetData::ComputeLibInfo(TargetInfo* info) const {
@@ -34,7 +135,6 @@ void ResolvedTargetData::ComputeLibInfo(TargetInfo* info) const {
 
   info->lib_dirs = all_lib_dirs.release();
   info->libs = all_libs.release();
-  info->has_lib_info = true;
 }
 
 void ResolvedTargetData::ComputeFrameworkInfo(TargetInfo* info) const {
@@ -60,7 +160,6 @@ void ResolvedTargetData::ComputeFrameworkInfo(TargetInfo* info) const {
   info->framework_dirs = all_framework_dirs.release();
   info->frameworks = all_frameworks.release();
   info->weak_frameworks = all_weak_frameworks.release();
-  info->has_framework_info = true;
 }
 
 void ResolvedTargetData::ComputeHardDeps(TargetInfo* info) const {
@@ -86,24 +185,19 @@ void ResolvedTargetData::ComputeHardDeps(TargetInfo* info) const {
     all_hard_deps.insert(dep_info->hard_deps);
   }
   info->hard_deps = std::move(all_hard_deps);
-  info->has_hard_deps = true;
 }
 
 void ResolvedTargetData::ComputeInheritedLibs(TargetInfo* info) const {
-  TargetPublicPairListBuilder inherited_libraries;
-
-  ComputeInheritedLibsFor(info->deps.public_deps(), true, &inherited_libraries);
+  ComputeInheritedLibsFor(info->deps.public_deps(), true,
+                          &info->inherited_libs);
   ComputeInheritedLibsFor(info->deps.private_deps(), false,
-                          &inherited_libraries);
-
-  info->inherited_libs = inherited_libraries.Build();
-  info->has_inherited_libs = true;
+                          &info->inherited_libs);
 }
 
 void ResolvedTargetData::ComputeInheritedLibsFor(
     base::span<const Target*> deps,
     bool is_public,
-    TargetPublicPairListBuilder* inherited_libraries) const {
+    PairListNode* inherited_libraries) const {
   for (const Target* dep : deps) {
     // Direct dependent libraries.
     if (dep->output_type() == Target::STATIC_LIBRARY ||
@@ -112,7 +206,7 @@ void ResolvedTargetData::ComputeInheritedLibsFor(
         dep->output_type() == Target::SOURCE_SET ||
         (dep->output_type() == Target::CREATE_BUNDLE &&
          dep->bundle_data().is_framework())) {
-      inherited_libraries->Append(dep, is_public);
+      inherited_libraries->AppendPair(dep, is_public);
     }
     if (dep->output_type() == Target::SHARED_LIBRARY) {
       // Shared library dependendencies are inherited across public shared
@@ -135,25 +229,19 @@ void ResolvedTargetData::ComputeInheritedLibsFor(
       // library boundaries because they will be linked into the shared
       // library. Rust dylib deps are handled above and transitive deps are
       // resolved by the compiler.
-      const TargetInfo* dep_info = GetTargetInheritedLibs(dep);
-      for (const auto& pair : dep_info->inherited_libs) {
-        if (pair.target()->output_type() == Target::SHARED_LIBRARY &&
-            pair.is_public()) {
-          inherited_libraries->Append(pair.target(), is_public);
-        }
-      }
+      const TargetInfo* dep_info = GetTargetSharedLibExports(dep);
+      inherited_libraries->AppendNode(&dep_info->shared_lib_exports,
+                                      is_public, kPairListNoFilter);
     } else if (!dep->IsFinal()) {
       // The current target isn't linked, so propagate linked deps and
       // libraries up the dependency tree.
+      //
+      // Proc macros are not linked into targets that depend on them, so do
+      // not get inherited; they are consumed by the Rust compiler and only
+      // need to be specified in --extern.
       const TargetInfo* dep_info = GetTargetInheritedLibs(dep);
-      for (const auto& pair : dep_info->inherited_libs) {
-        // Proc macros are not linked into targets that depend on them, so do
-        // not get inherited; they are consumed by the Rust compiler and only
-        // need to be specified in --extern.
-        if (pair.target()->output_type() != Target::RUST_PROC_MACRO)
-          inherited_libraries->Append(pair.target(),
-                                      is_public && pair.is_public());
-      }
+      inherited_libraries->AppendNode(&dep_info->inherited_libs, is_public,
+                                      kPairListSkipProcMacros);
     } else if (dep->complete_static_lib()) {
       // Inherit only final targets through _complete_ static libraries.
       //
@@ -163,29 +251,32 @@ void ResolvedTargetData::ComputeInheritedLibsFor(
       // complete static libraries link in non-final targets, they shouldn't be
       // inherited.
       const TargetInfo* dep_info = GetTargetInheritedLibs(dep);
-      for (const auto& pair : dep_info->inherited_libs) {
-        if (pair.target()->IsFinal())
-          inherited_libraries->Append(pair.target(),
-                                      is_public && pair.is_public());
-      }
+      inherited_libraries->AppendNode(&dep_info->inherited_libs, is_public,
+                                      kPairListFinalOnly);
     }
   }
 }
 
-void ResolvedTargetData::ComputeRustLibs(TargetInfo* info) const {
-  RustLibsBuilder rust_libs;
-
-  ComputeRustLibsFor(info->deps.public_deps(), true, &rust_libs);
-  ComputeRustLibsFor(info->deps.private_deps(), false, &rust_libs);
+void ResolvedTargetData::ComputeSharedLibExports(TargetInfo* info) const {
+  // This depends on the merged public flag of each library, so it can't be
+  // expressed as a filter over the node and is flattened once instead.
+  const TargetInfo* inherited = GetTargetInheritedLibs(info->target);
+  for (const auto& pair : FlattenPairList(&inherited->inherited_libs)) {
+    if (pair.target()->output_type() == Target::SHARED_LIBRARY &&
+        pair.is_public()) {
+      info->shared_lib_exports.AppendPair(pair.target(), true);
+    }
+  }
+}
 
-  info->rust_inherited_libs = rust_libs.inherited.Build();
-  info->rust_inheritable_libs = rust_libs.inheritable.Build();
-  info->has_rust_libs = true;
+void ResolvedTargetData::ComputeRustLibs(TargetInfo* info) const {
+  ComputeRustLibsFor(info->deps.public_deps(), true, info);
+  ComputeRustLibsFor(info->deps.private_deps(), false, info);
 }
 
 void ResolvedTargetData::ComputeRustLibsFor(base::span<const Target*> deps,
                                             bool is_public,
-                                            RustLibsBuilder* rust_libs) const {
+                                            TargetInfo* info) const {
   for (const Target* dep : deps) {
     // Collect Rust libraries that are accessible from the current target, or
     // transitively part of the current target.
@@ -206,20 +297,20 @@ void ResolvedTargetData::ComputeRustLibsFor(base::span<const Target*> deps,
       // as it's used for passing to rustc with --extern. We currently track
       // everything then drop non-Rust libs in
       // ninja_rust_binary_target_writer.cc.
-      rust_libs->inherited.Append(dep, true);
-      rust_libs->inheritable.Append(dep, is_public);
+      info->rust_inherited_libs.AppendPair(dep, true);
+      info->rust_inheritable_libs.AppendPair(dep, is_public);
 
       const TargetInfo* dep_info = GetTargetRustLibs(dep);
-      rust_libs->inherited.AppendInherited(dep_info->rust_inheritable_libs,
-                                           true);
-      rust_libs->inheritable.AppendInherited(dep_info->rust_inheritable_libs,
-                                             is_public);
+      info->rust_inherited_libs.AppendNode(&dep_info->rust_inheritable_libs,
+                                           true, kPairListNoFilter);
+      info->rust_inheritable_libs.AppendNode(&dep_info->rust_inheritable_libs,
+                                             is_public, kPairListNoFilter);
     } else if (dep->output_type() == Target::RUST_PROC_MACRO) {
       // Proc-macros are inherited as a transitive dependency, but the things
       // they depend on can't be used elsewhere, as the proc macro is not
       // linked into the target (as it's only used during compilation).
-      rust_libs->inherited.Append(dep, true);
-      rust_libs->inheritable.Append(dep, is_public);
+      info->rust_inherited_libs.AppendPair(dep, true);
+      info->rust_inheritable_libs.AppendPair(dep, is_public);
     }
   }
 }
@@ -261,5 +352,4 @@ void ResolvedTargetData::ComputeSwiftValues(TargetInfo* info) const {
     info->swift_values = std::make_unique<TargetInfo::SwiftValues>(
         modules.release(), public_modules.release());
   }
-  info->has_swift_values = true;
 }
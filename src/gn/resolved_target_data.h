@@ -5,7 +5,12 @@
 #ifndef TOOLS_GN_RESOLVED_TARGET_DATA_H_
 #define TOOLS_GN_RESOLVED_TARGET_DATA_H_
 
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "base/containers/span.h"
@@ -36,12 +41,18 @@
 //     data. For all methods, the input Target instance passed as argument
 //     must have been fully resolved (meaning that Target::OnResolved()
 //     must have been called and completed). Input target pointers are
-//     const and thus are never modified. This allows using multiple
-//     ResolvedTargetData instances from the same input graph in multiple
-//     threads safely.
+//     const and thus are never modified.
+//
+// All methods are thread-safe, so a single instance can be shared by all
+// threads writing targets of the same graph. Each value is computed exactly
+// once, by the first thread that needs it, and other threads asking for it
+// at the same time wait for the result.
 //
 class ResolvedTargetData {
  public:
+  ResolvedTargetData();
+  ~ResolvedTargetData();
+
   // Return the public/private/data/dependencies of a given target
   // as a ResolvedTargetDeps instance.
   const ResolvedTargetDeps& GetTargetDeps(const Target* target) const {
@@ -105,16 +116,22 @@ class ResolvedTargetData {
 
   // Retrieves an ordered list of (target, is_public) pairs for all link-time
   // libraries inherited by this target.
-  const std::vector<TargetPublicPair>& GetInheritedLibraries(
+  //
+  // The list is built on each call from a representation shared with the
+  // lists of the target's dependencies (see PairListNode), so callers should
+  // keep the result rather than calling this repeatedly, as
+  // NinjaBinaryTargetWriter does.
+  std::vector<TargetPublicPair> GetInheritedLibraries(
       const Target* target) const {
-    return GetTargetInheritedLibs(target)->inherited_libs;
+    return FlattenPairList(&GetTargetInheritedLibs(target)->inherited_libs);
   }
 
   // Retrieves an ordered list of (target, is_public) paris for all link-time
-  // libraries for Rust-specific binary targets.
-  const std::vector<TargetPublicPair>& GetRustInheritedLibraries(
+  // libraries for Rust-specific binary targets. See GetInheritedLibraries()
+  // for how the list is built.
+  std::vector<TargetPublicPair> GetRustInheritedLibraries(
       const Target* target) const {
-    return GetTargetRustLibs(target)->rust_inherited_libs;
+    return FlattenPairList(&GetTargetRustLibs(target)->rust_inherited_libs);
   }
 
   // List of dependent target that generate a .swiftmodule. The current target
@@ -129,6 +146,56 @@ class ResolvedTargetData {
   }
 
  private:
+  // Inherited library lists are mostly made of the lists of the dependencies,
+  // so materializing them for every target uses memory and time quadratic in
+  // the depth of the graph. Instead, each target stores a node listing its
+  // own pairs and references to the nodes of its dependencies, and the final
+  // list is only flattened on demand.
+  //
+  // The flattened list is what a TargetPublicPairListBuilder produces when
+  // given the entries in order, where a reference entry stands for the
+  // flattened list of the referenced node, with its pairs made private
+  // unless |is_public| is set and restricted by |filter|.
+  enum PairListFilter : uint8_t {
+    kPairListNoFilter = 0,
+    // Skips Rust proc macros, which are not linked into their dependents.
+    kPairListSkipProcMacros = 1 << 0,
+    // Only keeps final targets, see Target::IsFinal().
+    kPairListFinalOnly = 1 << 1,
+  };
+
+  struct PairListNode {
+    struct Entry {
+      // Null for an entry holding a single pair.
+      const PairListNode* node;
+      const Target* target;
+      bool is_public;
+      uint8_t filter;
+    };
+
+    void AppendPair(const Target* target, bool is_public) {
+      entries.push_back({nullptr, target, is_public, kPairListNoFilter});
+    }
+    void AppendNode(const PairListNode* node, bool is_public, uint8_t filter) {
+      entries.push_back({node, nullptr, is_public, filter});
+    }
+
+    std::vector<Entry> entries;
+  };
+
+  // Returns the flattened list of |node|.
+  static std::vector<TargetPublicPair> FlattenPairList(
+      const PairListNode* node);
+
+  // Appends the flattened list of |node| to the flattener's result. Each node
+  // is only walked once per combination of |is_public| and |filter|, since
+  // walking it again could not change the result.
+  struct PairListFlattener;
+  static void FlattenPairListInto(const PairListNode* node,
+                                  bool is_public,
+                                  uint8_t filter,
+                                  PairListFlattener* flattener);
+
   // The information associated with a given Target pointer.
   struct TargetInfo {
     TargetInfo() = default;
@@ -142,33 +209,41 @@ class ResolvedTargetData {
     const Target* target = nullptr;
     ResolvedTargetDeps deps;
 
-    bool has_lib_info = false;
-    bool has_framework_info = false;
-    bool has_hard_deps = false;
-    bool has_inherited_libs = false;
-    bool has_rust_libs = false;
-    bool has_swift_values = false;
-
-    // Only valid if |has_lib_info| is true.
+    // Each group of values below is computed the first time it is requested,
+    // guarded by the corresponding flag.
+    std::once_flag lib_info_once;
+    std::once_flag framework_info_once;
+    std::once_flag hard_deps_once;
+    std::once_flag inherited_libs_once;
+    std::once_flag shared_lib_exports_once;
+    std::once_flag rust_libs_once;
+    std::once_flag swift_values_once;
+
+    // Only valid once |lib_info_once| is set.
     std::vector<SourceDir> lib_dirs;
     std::vector<LibFile> libs;
 
-    // Only valid if |has_framework_info| is true.
+    // Only valid once |framework_info_once| is set.
     std::vector<SourceDir> framework_dirs;
     std::vector<std::string> frameworks;
     std::vector<std::string> weak_frameworks;
 
-    // Only valid if |has_hard_deps| is true.
+    // Only valid once |hard_deps_once| is set.
     TargetSet hard_deps;
 
-    // Only valid if |has_inherited_libs| is true.
-    std::vector<TargetPublicPair> inherited_libs;
+    // Only valid once |inherited_libs_once| is set.
+    PairListNode inherited_libs;
 
-    // Only valid if |has_rust_libs| is true.
-    std::vector<TargetPublicPair> rust_inherited_libs;
-    std::vector<TargetPublicPair> rust_inheritable_libs;
+    // Only valid once |shared_lib_exports_once| is set. For shared libraries,
+    // the public shared libraries from inherited_libs, which are inherited by
+    // their dependents.
+    PairListNode shared_lib_exports;
 
-    // Only valid if |has_swift_values| is true.
+    // Only valid once |rust_libs_once| is set.
+    PairListNode rust_inherited_libs;
+    PairListNode rust_inheritable_libs;
+
+    // Only valid once |swift_values_once| is set.
     // Most targets will not have Swift dependencies, so only
     // allocate a SwiftValues struct when needed. A null pointer
     // indicates empty lists.
@@ -188,92 +263,99 @@ class ResolvedTargetData {
   // a new empty instance on demand if none is already available.
   TargetInfo* GetTargetInfo(const Target* target) const;
 
+  // Slots for TargetInfo instances are indexed by Item::resolved_index(), in
+  // chunks allocated on demand. A slot is set once with a compare-and-swap,
+  // so looking up a target doesn't take a lock. Chunks are small, and their
+  // table is only allocated by the first lookup, so that short-lived
+  // instances describing a few targets stay cheap.
+  static constexpr size_t kChunkSize = 512;
+  static constexpr size_t kMaxChunks = 8192;
+  using Chunk = std::array<std::atomic<TargetInfo*>, kChunkSize>;
+
   const TargetInfo* GetTargetLibInfo(const Target* target) const {
     TargetInfo* info = GetTargetInfo(target);
-    if (!info->has_lib_info) {
-      ComputeLibInfo(info);
-      DCHECK(info->has_lib_info);
-    }
+    std::call_once(info->lib_info_once,
+                   [this, info]() { ComputeLibInfo(info); });
     return info;
   }
 
   const TargetInfo* GetTargetFrameworkInfo(const Target* target) const {
     TargetInfo* info = GetTargetInfo(target);
-    if (!info->has_framework_info) {
-      ComputeFrameworkInfo(info);
-      DCHECK(info->has_framework_info);
-    }
+    std::call_once(info->framework_info_once,
+                   [this, info]() { ComputeFrameworkInfo(info); });
     return info;
   }
 
   const TargetInfo* GetTargetHardDeps(const Target* target) const {
     TargetInfo* info = GetTargetInfo(target);
-    if (!info->has_hard_deps) {
-      ComputeHardDeps(info);
-      DCHECK(info->has_hard_deps);
-    }
+    std::call_once(info->hard_deps_once,
+                   [this, info]() { ComputeHardDeps(info); });
     return info;
   }
 
   const TargetInfo* GetTargetInheritedLibs(const Target* target) const {
     TargetInfo* info = GetTargetInfo(target);
-    if (!info->has_inherited_libs) {
-      ComputeInheritedLibs(info);
-      DCHECK(info->has_inherited_libs);
-    }
+    std::call_once(info->inherited_libs_once,
+                   [this, info]() { ComputeInheritedLibs(info); });
+    return info;
+  }
+
+  const TargetInfo* GetTargetSharedLibExports(const Target* target) const {
+    TargetInfo* info = GetTargetInfo(target);
+    std::call_once(info->shared_lib_exports_once,
+                   [this, info]() { ComputeSharedLibExports(info); });
     return info;
   }
 
   const TargetInfo* GetTargetRustLibs(const Target* target) const {
     TargetInfo* info = GetTargetInfo(target);
-    if (!info->has_rust_libs) {
-      ComputeRustLibs(info);
-      DCHECK(info->has_rust_libs);
-    }
+    std::call_once(info->rust_libs_once,
+                   [this, info]() { ComputeRustLibs(info); });
     return info;
   }
 
   const TargetInfo* GetTargetSwiftValues(const Target* target) const {
     TargetInfo* info = GetTargetInfo(target);
-    if (!info->has_swift_values) {
-      ComputeSwiftValues(info);
-      DCHECK(info->has_swift_values);
-    }
+    std::call_once(info->swift_values_once,
+                   [this, info]() { ComputeSwiftValues(info); });
     return info;
   }
 
-  // Compute the portion of TargetInfo guarded by one of the |has_xxx|
-  // booleans. This performs recursive and expensive computations and
+  // Compute the portion of TargetInfo guarded by one of the |xxx_once|
+  // flags. This performs recursive and expensive computations and
   // should only be called once per TargetInfo instance.
   void ComputeLibInfo(TargetInfo* info) const;
   void ComputeFrameworkInfo(TargetInfo* info) const;
   void ComputeHardDeps(TargetInfo* info) const;
   void ComputeInheritedLibs(TargetInfo* info) const;
+  void ComputeSharedLibExports(TargetInfo* info) const;
   void ComputeRustLibs(TargetInfo* info) const;
   void ComputeSwiftValues(TargetInfo* info) const;
 
-  // Helper function used by ComputeInheritedLibs().
-  void ComputeInheritedLibsFor(
-      base::span<const Target*> deps,
-      bool is_public,
-      TargetPublicPairListBuilder* inherited_libraries) const;
-
-  // Helper data structure and function used by ComputeRustLibs().
-  struct RustLibsBuilder {
-    TargetPublicPairListBuilder inherited;
-    TargetPublicPairListBuilder inheritable;
-  };
-
+  // Helper functions used by ComputeInheritedLibs() and ComputeRustLibs().
+  void ComputeInheritedLibsFor(base::span<const Target*> deps,
+                               bool is_public,
+                               PairListNode* inherited_libraries) const;
   void ComputeRustLibsFor(base::span<const Target*> deps,
                           bool is_public,
-                          RustLibsBuilder* rust_libs) const;
-
-  // A { Target* -> TargetInfo } map that will create entries
-  // on demand (hence the mutable qualifier). Implemented with a
-  // UniqueVector<> and a parallel vector of unique TargetInfo
-  // instances for best performance.
-  mutable UniqueVector<const Target*> targets_;
-  mutable std::vector<std::unique_ptr<TargetInfo>> infos_;
+                          TargetInfo* info) const;
+
+  // The table of kMaxChunks indexed chunks, see kChunkSize. The table, its
+  // chunks and their entries are created on demand (hence the mutable
+  // qualifier) and owned by this instance.
+  mutable std::atomic<std::atomic<Chunk*>*> chunks_{nullptr};
+
+  // A { Target* -> TargetInfo } map for targets without a resolved index
+  // (which were not resolved by a Builder, e.g. in tests), beyond the indexed
+  // slots, or whose slot is used by a target of another graph. Implemented
+  // with a UniqueVector<> and a parallel vector of unique TargetInfo
+  // instances.
+  mutable std::mutex unindexed_lock_;
+  mutable UniqueVector<const Target*> unindexed_targets_;
+  mutable std::vector<std::unique_ptr<TargetInfo>> unindexed_infos_;
+
+  ResolvedTargetData(const ResolvedTargetData&) = delete;
+  ResolvedTargetData& operator=(const ResolvedTargetData&) = delete;
 };
 
 #endif  // TOOLS_GN_RESOLVED_TARGET_DATA_H_
@@ -4,6 +4,11 @@
 
 #include "gn/resolved_target_data.h"
 
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "gn/test_with_scope.h"
 #include "util/test/test.h"
 
@@ -408,3 +413,106 @@ TEST(ResolvedTargetDataTest, SharedInheritance) {
   EXPECT_EQ(&inter, exe_inherited[0].target());
   EXPECT_EQ(&pub, exe_inherited[1].target());
 }
+
+// Inherited libraries reached through several paths are listed once, at their
+// first position, and are public if any of the paths is.
+TEST(ResolvedTargetDataTest, InheritThroughDiamond) {
+  TestWithScope setup;
+  Err err;
+
+  //   exe -> left --[public]--> base -> leaf
+  //       -> right ------------> base
+  //       --[public]--> right
+  TestTarget leaf(setup, "//foo:leaf", Target::STATIC_LIBRARY);
+  ASSERT_TRUE(leaf.OnResolved(&err));
+
+  TestTarget base(setup, "//foo:base", Target::SOURCE_SET);
+  base.public_deps().push_back(LabelTargetPair(&leaf));
+  ASSERT_TRUE(base.OnResolved(&err));
+
+  TestTarget left(setup, "//foo:left", Target::SOURCE_SET);
+  left.private_deps().push_back(LabelTargetPair(&base));
+  ASSERT_TRUE(left.OnResolved(&err));
+
+  TestTarget right(setup, "//foo:right", Target::STATIC_LIBRARY);
+  right.public_deps().push_back(LabelTargetPair(&base));
+  ASSERT_TRUE(right.OnResolved(&err));
+
+  TestTarget exe(setup, "//foo:exe", Target::EXECUTABLE);
+  exe.private_deps().push_back(LabelTargetPair(&left));
+  exe.public_deps().push_back(LabelTargetPair(&right));
+  ASSERT_TRUE(exe.OnResolved(&err));
+
+  ResolvedTargetData resolved;
+  const auto& left_inherited = resolved.GetInheritedLibraries(&left);
+  ASSERT_EQ(2u, left_inherited.size());
+  EXPECT_EQ(&base, left_inherited[0].target());
+  EXPECT_FALSE(left_inherited[0].is_public());
+  EXPECT_EQ(&leaf, left_inherited[1].target());
+  EXPECT_FALSE(left_inherited[1].is_public());
+
+  // Public deps come first, so right's libraries are listed before left's.
+  const auto& exe_inherited = resolved.GetInheritedLibraries(&exe);
+  ASSERT_EQ(4u, exe_inherited.size());
+  EXPECT_EQ(&right, exe_inherited[0].target());
+  EXPECT_TRUE(exe_inherited[0].is_public());
+  EXPECT_EQ(&base, exe_inherited[1].target());
+  EXPECT_TRUE(exe_inherited[1].is_public());
+  EXPECT_EQ(&leaf, exe_inherited[2].target());
+  EXPECT_TRUE(exe_inherited[2].is_public());
+  EXPECT_EQ(&left, exe_inherited[3].target());
+  EXPECT_FALSE(exe_inherited[3].is_public());
+}
+
+// Tests that one instance can be queried from several threads at once, for
+// targets both with and without a resolved index.
+TEST(ResolvedTargetDataTest, SharedAcrossThreads) {
+  TestWithScope setup;
+  Err err;
+
+  // A chain of static libraries, each with its own lib, linked into an
+  // executable. Every other target gets a resolved index.
+  constexpr size_t kChainLength = 50;
+  std::vector<std::unique_ptr<TestTarget>> chain;
+  for (size_t i = 0; i < kChainLength; i++) {
+    auto target = std::make_unique<TestTarget>(
+        setup, "//foo:lib" + std::to_string(i),
+        Target::STATIC_LIBRARY);
+    target->config_values().libs().push_back(
+        LibFile("lib" + std::to_string(i)));
+    if (i > 0)
+      target->private_deps().push_back(LabelTargetPair(chain.back().get()));
+    if (i % 2 == 0)
+      target->set_resolved_index(i);
+    ASSERT_TRUE(target->OnResolved(&err));
+    chain.push_back(std::move(target));
+  }
+  TestTarget exec(setup, "//foo:exec", Target::EXECUTABLE);
+  exec.private_deps().push_back(LabelTargetPair(chain.back().get()));
+  ASSERT_TRUE(exec.OnResolved(&err));
+
+  ResolvedTargetData resolved;
+  constexpr int kThreads = 4;
+  std::vector<std::vector<LibFile>> results(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&resolved, &exec, &results, t]() {
+      results[t] = resolved.GetLinkedLibraries(&exec);
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  // Libraries are listed from the closest dependency to the farthest.
+  ASSERT_EQ(kChainLength, results[0].size());
+  for (size_t i = 0; i < kChainLength; i++) {
+    EXPECT_EQ(LibFile("lib" + std::to_string(kChainLength - 1 - i)),
+              results[0][i]);
+  }
+  for (int t = 1; t < kThreads; t++)
+    EXPECT_EQ(results[0], results[t]);
+
+  // The values were computed once and are shared.
+  EXPECT_EQ(&resolved.GetLinkedLibraries(&exec),
+            &resolved.GetLinkedLibraries(&exec));
+}
@@ -4,9 +4,9 @@
 
 #include "gn/runtime_deps.h"
 
-#include <map>
-#include <set>
+#include <optional>
 #include <sstream>
+#include <unordered_map>
 
 #include "base/command_line.h"
 #include "base/files/file_util.h"
@@ -17,54 +17,161 @@
 #include "gn/filesystem_utils.h"
 #include "gn/loader.h"
 #include "gn/output_file.h"
+#include "gn/pointer_set.h"
 #include "gn/scheduler.h"
 #include "gn/settings.h"
 #include "gn/string_output_buffer.h"
 #include "gn/switches.h"
 #include "gn/target.h"
 #include "gn/trace.h"
+#include "util/worker_pool.h"
 
 namespace {
 
 using RuntimeDepsVector = std::vector<std::pair<OutputFile, const Target*>>;
 
-// Adds the given file to the deps list if it hasn't already been listed in
-// the found_files list. Updates the list.
-void AddIfNew(const OutputFile& output_file,
-              const Target* source,
-              RuntimeDepsVector* deps,
-              std::set<OutputFile>* found_file) {
-  if (found_file->find(output_file) != found_file->end())
-    return;  // Already there.
-  deps->push_back(std::make_pair(output_file, source));
+// The runtime files a single target contributes, independent of which root
+// target the runtime deps are being computed for. Producing these requires
+// rebasing every data file and action output, which dominates the cost of a
+// traversal, so they're computed once per target and shared by all roots.
+struct TargetRuntimeFiles {
+  // Runtime outputs (for linked binaries) followed by the data files. These
+  // are always runtime deps.
+  std::vector<OutputFile> files;
+
+  // Outputs of actions and copies, which only count when the target is
+  // reached through a data dependency.
+  std::vector<OutputFile> data_dep_outputs;
+
+  // The bundle root directory for create_bundle targets.
+  std::optional<OutputFile> bundle_root_dir;
+};
+
+OutputFile RebaseToOutputFile(const std::string& str, const Target* source) {
+  return OutputFile(
+      RebasePath(str, source->settings()->build_settings()->build_dir(),
+                 source->settings()->build_settings()->root_path_utf8()));
 }
 
-// Automatically converts a string that looks like a source to an OutputFile.
-void AddIfNew(const std::string& str,
+// Returns true if the runtime deps of |target| should include the given
+// linked (non-data) dependency.
+bool ShouldRecurseIntoLinkedDep(const Target* target, const Target* dep) {
+  if (dep->output_type() == Target::EXECUTABLE)
+    return false;  // Skip executables that aren't data deps.
+  if (dep->output_type() == Target::SHARED_LIBRARY &&
+      (target->output_type() == Target::ACTION ||
+       target->output_type() == Target::ACTION_FOREACH)) {
+    // Skip shared libraries that action depends on,
+    // unless it were listed in data deps.
+    return false;
+  }
+  return true;
+}
+
+// Caches the TargetRuntimeFiles of every target reachable from a set of
+// roots. Once populated (on one thread), lookups are read-only and may be
+// made concurrently.
+class RuntimeFilesCache {
+ public:
+  RuntimeFilesCache() = default;
+
+  // Adds the runtime files of all targets whose runtime deps may contribute
+  // to those of |root|.
+  void AddTargetAndDeps(const Target* root) {
+    if (!visited_.add(root))
+      return;
+    files_[root] = ComputeFiles(root);
+
+    for (const auto& dep_pair : root->data_deps())
+      AddTargetAndDeps(dep_pair.ptr);
+
+    // Do not recurse into bundle targets, see RecursiveCollectRuntimeDeps.
+    if (root->output_type() == Target::CREATE_BUNDLE)
+      return;
+
+    for (const auto& dep_pair : root->GetDeps(Target::DEPS_LINKED)) {
+      if (ShouldRecurseIntoLinkedDep(root, dep_pair.ptr))
+        AddTargetAndDeps(dep_pair.ptr);
+    }
+  }
+
+  const TargetRuntimeFiles& Get(const Target* target) const {
+    auto found = files_.find(target);
+    DCHECK(found != files_.end());
+    return found->second;
+  }
+
+ private:
+  static TargetRuntimeFiles ComputeFiles(const Target* target) {
+    TargetRuntimeFiles result;
+
+    // Add the main output file for executables, shared libraries, and
+    // loadable modules.
+    if (target->output_type() == Target::EXECUTABLE ||
+        target->output_type() == Target::LOADABLE_MODULE ||
+        target->output_type() == Target::SHARED_LIBRARY) {
+      for (const auto& runtime_output : target->runtime_outputs())
+        result.files.push_back(runtime_output);
+    }
+
+    // Add all data files.
+    for (const auto& file : target->data())
+      result.files.push_back(RebaseToOutputFile(file, target));
+
+    // Actions/copy have all outputs considered when the're a data dep.
+    if (target->output_type() == Target::ACTION ||
+        target->output_type() == Target::ACTION_FOREACH ||
+        target->output_type() == Target::COPY_FILES) {
+      std::vector<SourceFile> outputs;
+      target->action_values().GetOutputsAsSourceFiles(target, &outputs);
+      for (const auto& output_file : outputs) {
+        result.data_dep_outputs.push_back(
+            RebaseToOutputFile(output_file.value(), target));
+      }
+    }
+
+    if (target->output_type() == Target::CREATE_BUNDLE) {
+      SourceDir bundle_root_dir =
+          target->bundle_data().GetBundleRootDirOutputAsDir(target->settings());
+      result.bundle_root_dir =
+          RebaseToOutputFile(bundle_root_dir.value(), target);
+    }
+    return result;
+  }
+
+  PointerSet<const Target> visited_;
+  std::unordered_map<const Target*, TargetRuntimeFiles> files_;
+
+  RuntimeFilesCache(const RuntimeFilesCache&) = delete;
+  RuntimeFilesCache& operator=(const RuntimeFilesCache&) = delete;
+};
+
+// The targets visited so far during the computation of the runtime deps of
+// one root. Targets seen as data deps are in both sets.
+struct SeenTargets {
+  PointerSet<const Target> all;
+  PointerSet<const Target> as_data_dep;
+};
+
+void AddFiles(const std::vector<OutputFile>& files,
               const Target* source,
-              RuntimeDepsVector* deps,
-              std::set<OutputFile>* found_file) {
-  OutputFile output_file(
-      RebasePath(str, source->settings()->build_settings()->build_dir(),
-                 source->settings()->build_settings()->root_path_utf8()));
-  AddIfNew(output_file, source, deps, found_file);
+              RuntimeDepsVector* deps) {
+  for (const auto& file : files)
+    deps->push_back(std::make_pair(file, source));
 }
 
-// To avoid duplicate traversals of targets, or duplicating output files that
-// might be listed by more than one target, the set of targets and output files
-// that have been found so far is passed. The "value" of the seen_targets map
-// is a boolean indicating if the seen dep was a data dep (true = data_dep).
+// To avoid duplicate traversals of targets, the set of targets that have been
+// found so far is passed. Targets seen as a data dep are tracked separately:
 // data deps add more stuff, so we will want to revisit a target if it's a
 // data dependency and we've previously only seen it as a regular dep.
 void RecursiveCollectRuntimeDeps(const Target* target,
                                  bool is_target_data_dep,
+                                 const RuntimeFilesCache& cache,
                                  RuntimeDepsVector* deps,
-                                 std::map<const Target*, bool>* seen_targets,
-                                 std::set<OutputFile>* found_files) {
-  const auto& found_seen_target = seen_targets->find(target);
-  if (found_seen_target != seen_targets->end()) {
+                                 SeenTargets* seen_targets) {
+  if (!seen_targets->all.add(target)) {
     // Already visited.
-    if (found_seen_target->second || !is_target_data_dep) {
+    if (!is_target_data_dep || seen_targets->as_data_dep.contains(target)) {
       // Already visited as a data dep, or the current dep is not a data
       // dep so visiting again will be a no-op.
       return;
@@ -72,62 +179,47 @@ void RecursiveCollectRuntimeDeps(const Target* target,
     // In the else case, the previously seen target was a regular dependency
     // and we'll now process it as a data dependency.
   }
-  (*seen_targets)[target] = is_target_data_dep;
-
-  // Add the main output file for executables, shared libraries, and
-  // loadable modules.
-  if (target->output_type() == Target::EXECUTABLE ||
-      target->output_type() == Target::LOADABLE_MODULE ||
-      target->output_type() == Target::SHARED_LIBRARY) {
-    for (const auto& runtime_output : target->runtime_outputs())
-      AddIfNew(runtime_output, target, deps, found_files);
-  }
+  if (is_target_data_dep)
+    seen_targets->as_data_dep.add(target);
 
-  // Add all data files.
-  for (const auto& file : target->data())
-    AddIfNew(file, target, deps, found_files);
-
-  // Actions/copy have all outputs considered when the're a data dep.
-  if (is_target_data_dep && (target->output_type() == Target::ACTION ||
-                             target->output_type() == Target::ACTION_FOREACH ||
-                             target->output_type() == Target::COPY_FILES)) {
-    std::vector<SourceFile> outputs;
-    target->action_values().GetOutputsAsSourceFiles(target, &outputs);
-    for (const auto& output_file : outputs)
-      AddIfNew(output_file.value(), target, deps, found_files);
-  }
+  const TargetRuntimeFiles& files = cache.Get(target);
+  AddFiles(files.files, target, deps);
+  if (is_target_data_dep)
+    AddFiles(files.data_dep_outputs, target, deps);
 
   // Data dependencies.
   for (const auto& dep_pair : target->data_deps()) {
-    RecursiveCollectRuntimeDeps(dep_pair.ptr, true, deps, seen_targets,
-                                found_files);
+    RecursiveCollectRuntimeDeps(dep_pair.ptr, true, cache, deps, seen_targets);
   }
 
   // Do not recurse into bundle targets. A bundle's dependencies should be
   // copied into the bundle itself for run-time access.
   if (target->output_type() == Target::CREATE_BUNDLE) {
-    SourceDir bundle_root_dir =
-        target->bundle_data().GetBundleRootDirOutputAsDir(target->settings());
-    AddIfNew(bundle_root_dir.value(), target, deps, found_files);
+    deps->push_back(std::make_pair(*files.bundle_root_dir, target));
     return;
   }
 
   // Non-data dependencies (both public and private).
   for (const auto& dep_pair : target->GetDeps(Target::DEPS_LINKED)) {
-    if (dep_pair.ptr->output_type() == Target::EXECUTABLE)
-      continue;  // Skip executables that aren't data deps.
-    if (dep_pair.ptr->output_type() == Target::SHARED_LIBRARY &&
-        (target->output_type() == Target::ACTION ||
-         target->output_type() == Target::ACTION_FOREACH)) {
-      // Skip shared libraries that action depends on,
-      // unless it were listed in data deps.
-      continue;
+    if (ShouldRecurseIntoLinkedDep(target, dep_pair.ptr)) {
+      RecursiveCollectRuntimeDeps(dep_pair.ptr, false, cache, deps,
+                                  seen_targets);
     }
-    RecursiveCollectRuntimeDeps(dep_pair.ptr, false, deps, seen_targets,
-                                found_files);
   }
 }
 
+RuntimeDepsVector ComputeRuntimeDepsWithCache(const Target* target,
+                                              const RuntimeFilesCache& cache) {
+  RuntimeDepsVector result;
+  SeenTargets seen_targets;
+
+  // The initial target is not considered a data dependency so that actions's
+  // outputs (if the current target is an action) are not automatically
+  // considered data deps.
+  RecursiveCollectRuntimeDeps(target, false, cache, &result, &seen_targets);
+  return result;
+}
+
 bool CollectRuntimeDepsFromFlag(const BuildSettings* build_settings,
                                 const Builder& builder,
                                 RuntimeDepsVector* files_to_write,
@@ -206,6 +298,7 @@ bool CollectRuntimeDepsFromFlag(const BuildSettings* build_settings,
 
 bool WriteRuntimeDepsFile(const OutputFile& output_file,
                           const Target* target,
+                          const RuntimeFilesCache& cache,
                           Err* err) {
   SourceFile output_as_source =
       output_file.AsSourceFile(target->settings()->build_settings());
@@ -214,7 +307,7 @@ bool WriteRuntimeDepsFile(const OutputFile& output_file,
 
   StringOutputBuffer storage;
   std::ostream contents(&storage);
-  for (const auto& pair : ComputeRuntimeDeps(target))
+  for (const auto& pair : ComputeRuntimeDepsWithCache(target, cache))
     contents << pair.first.value() << std::endl;
 
   ScopedTrace trace(TraceItem::TRACE_FILE_WRITE, output_as_source.value());
@@ -293,16 +386,9 @@ Multiple outputs
 )";
 
 RuntimeDepsVector ComputeRuntimeDeps(const Target* target) {
-  RuntimeDepsVector result;
-  std::map<const Target*, bool> seen_targets;
-  std::set<OutputFile> found_files;
-
-  // The initial target is not considered a data dependency so that actions's
-  // outputs (if the current target is an action) are not automatically
-  // considered data deps.
-  RecursiveCollectRuntimeDeps(target, false, &result, &seen_targets,
-                              &found_files);
-  return result;
+  RuntimeFilesCache cache;
+  cache.AddTargetAndDeps(target);
+  return ComputeRuntimeDepsWithCache(target, cache);
 }
 
 bool WriteRuntimeDepsFilesIfNecessary(const BuildSettings* build_settings,
@@ -319,12 +405,39 @@ bool WriteRuntimeDepsFilesIfNecessary(const BuildSettings* build_settings,
         std::make_pair(target->write_runtime_deps_output(), target));
   }
 
-  for (const auto& entry : files_to_write) {
-    // Currently this writes all runtime deps files sequentially. We generally
-    // expect few of these. We can run this on the worker pool if it looks
-    // like it's talking a long time.
-    if (!WriteRuntimeDepsFile(entry.first, entry.second, err))
+  // A file may be requested more than once (e.g. by the flag and by
+  // write_runtime_deps). Only the last request for each file is written, as
+  // it would have been overwritten when writing sequentially.
+  std::unordered_map<OutputFile, size_t> last_write_index;
+  for (size_t i = 0; i < files_to_write.size(); i++)
+    last_write_index[files_to_write[i].first] = i;
+
+  // Targets with runtime deps files frequently share most of their
+  // dependencies (e.g. many test executables), so compute each target's
+  // runtime files once up front. The cache is only read by the writers.
+  RuntimeFilesCache cache;
+  for (const auto& entry : files_to_write)
+    cache.AddTargetAndDeps(entry.second);
+
+  std::vector<Err> errors(files_to_write.size());
+  {
+    // The pool waits for all posted tasks when it goes out of scope.
+    WorkerPool pool;
+    for (size_t i = 0; i < files_to_write.size(); i++) {
+      if (last_write_index[files_to_write[i].first] != i)
+        continue;
+      pool.PostTask([&entry = files_to_write[i], &cache, &err = errors[i]]() {
+        WriteRuntimeDepsFile(entry.first, entry.second, cache, &err);
+      });
+    }
+  }
+
+  // Report the first error in request order so the result is deterministic.
+  for (const Err& write_err : errors) {
+    if (write_err.has_error()) {
+      *err = write_err;
       return false;
+    }
   }
   return true;
 }
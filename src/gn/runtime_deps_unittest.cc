@@ -419,6 +419,54 @@ TEST_F(RuntimeDeps, Dupe) {
       << GetVectorDescription(result);
 }
 
+// Tests that a dependency first reached as a regular dep through one target
+// and later as a data dep through another is processed as a data dep.
+TEST_F(RuntimeDeps, DataDepAfterRegularDep) {
+  TestWithScope setup;
+  Err err;
+
+  // Dependency hierarchy: main(exe) -> regular(source set) -> action
+  //                                 -> data(group) -> [data_deps] action
+
+  Target action(setup.settings(), Label(SourceDir("//"), "action"));
+  InitTargetWithType(setup, &action, Target::ACTION);
+  action.data().push_back("//action.data");
+  action.action_values().outputs() =
+      SubstitutionList::MakeForTest("//action.output");
+  ASSERT_TRUE(action.OnResolved(&err));
+
+  Target regular(setup.settings(), Label(SourceDir("//"), "regular"));
+  InitTargetWithType(setup, &regular, Target::SOURCE_SET);
+  regular.private_deps().push_back(LabelTargetPair(&action));
+  ASSERT_TRUE(regular.OnResolved(&err));
+
+  Target data(setup.settings(), Label(SourceDir("//"), "data"));
+  InitTargetWithType(setup, &data, Target::GROUP);
+  data.data_deps().push_back(LabelTargetPair(&action));
+  ASSERT_TRUE(data.OnResolved(&err));
+
+  Target main(setup.settings(), Label(SourceDir("//"), "main"));
+  InitTargetWithType(setup, &main, Target::EXECUTABLE);
+  main.private_deps().push_back(LabelTargetPair(&regular));
+  main.private_deps().push_back(LabelTargetPair(&data));
+  ASSERT_TRUE(main.OnResolved(&err));
+
+  std::vector<std::pair<OutputFile, const Target*>> result =
+      ComputeRuntimeDeps(&main);
+  EXPECT_EQ(MakePair("./main", &main), result[0]);
+  EXPECT_TRUE(
+      base::ContainsValue(result, MakePair("../../action.data", &action)))
+      << GetVectorDescription(result);
+  EXPECT_TRUE(
+      base::ContainsValue(result, MakePair("../../action.output", &action)))
+      << GetVectorDescription(result);
+
+  // The regular dependency alone does not pull in the action outputs.
+  result = ComputeRuntimeDeps(&regular);
+  ASSERT_EQ(1u, result.size()) << GetVectorDescription(result);
+  EXPECT_EQ(MakePair("../../action.data", &action), result[0]);
+}
+
 // Tests that actions can't have output substitutions.
 TEST_F(RuntimeDeps, WriteRuntimeDepsVariable) {
   TestWithScope setup;
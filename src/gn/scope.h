@@ -14,6 +14,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/hash.h"
 #include "base/memory/ref_counted.h"
 #include "gn/err.h"
 #include "gn/location.h"
@@ -356,7 +357,8 @@ class Scope {
     Value value;
   };
 
-  using RecordMap = std::unordered_map<std::string_view, Record>;
+  using RecordMap =
+      std::unordered_map<std::string_view, Record, base::StringHash>;
 
   void AddProvider(ProgrammaticProvider* p);
   void RemoveProvider(ProgrammaticProvider* p);
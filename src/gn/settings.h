@@ -6,6 +6,7 @@
 #define TOOLS_GN_SETTINGS_H_
 
 #include "base/files/file_path.h"
+#include "gn/flag_block_cache.h"
 #include "gn/import_manager.h"
 #include "gn/output_file.h"
 #include "gn/scope.h"
@@ -74,6 +75,11 @@ class Settings {
   // const pointer.
   ImportManager& import_manager() const { return import_manager_; }
 
+  // Shared compiler flag blocks rendered by the ninja target writers for this
+  // toolchain. Like the import manager, this is a thread-safe cache and so
+  // is available from a const object.
+  FlagBlockCache& flag_block_cache() const { return flag_block_cache_; }
+
   const Scope* base_config() const { return &base_config_; }
   Scope* base_config() { return &base_config_; }
 
@@ -98,6 +104,7 @@ class Settings {
   Label default_toolchain_label_;
 
   mutable ImportManager import_manager_;
+  mutable FlagBlockCache flag_block_cache_;
 
   // The subdirectory inside the build output for this toolchain. For the
   // default toolchain, this will be empty (since the default toolchain's
@@ -208,6 +208,24 @@ Variables
       rules instead of stamp files whenever possible. This results in smaller
       Ninja build plans, but requires at least Ninja 1.11.
 
+  ninja_shared_flag_sets [optional]
+      A boolean flag that can be set to write the compiler flag values of C
+      and C++ targets (cflags, defines, include_dirs, etc.) once as variables
+      in the toolchain's Ninja file. Targets with identical values then only
+      reference the variable instead of repeating the flags, which results in
+      much smaller Ninja files for large builds.
+
+  ninja_target_shards [optional]
+      An integer that can be set to write the Ninja rules of the binary
+      targets (executables, libraries and source sets) of each toolchain to
+      this many shard files instead of one file per target. Targets are
+      assigned to shards by label, and each shard is only rewritten when its
+      contents change. This reduces the number of files GN creates and
+      compares, which matters on slow file systems. Since targets share a
+      file, their compiler flags are bound on each build statement; combine
+      with ninja_shared_flag_sets to keep the files small. Defaults to 0,
+      which writes one file per target.
+
 Example .gn file contents
 
   buildconfig = "//build/config/BUILDCONFIG.gn"
@@ -247,29 +265,6 @@ base::FilePath FindDotFile(const base::FilePath& current_dir) {
   return FindDotFile(up_one_dir);
 }
 
-// Called on any thread. Post the item to the builder on the main thread.
-void ItemDefinedCallback(MsgLoop* task_runner,
-                         Builder* builder_call_on_main_thread_only,
-                         std::unique_ptr<Item> item) {
-  DCHECK(item);
-
-  // Increment the work count for the duration of defining the item with the
-  // builder. Otherwise finishing this callback will race finishing loading
-  // files. If there is no other pending work at any point in the middle of
-  // this call completing on the main thread, the 'Complete' function will
-  // be signaled and we'll stop running with an incomplete build.
-  g_scheduler->IncrementWorkCount();
-
-  // Work around issue binding a unique_ptr with std::function by moving into a
-  // shared_ptr.
-  auto item_shared = std::make_shared<std::unique_ptr<Item>>(std::move(item));
-  task_runner->PostTask(
-      [builder_call_on_main_thread_only, item_shared]() mutable {
-        builder_call_on_main_thread_only->ItemDefined(std::move(*item_shared));
-        g_scheduler->DecrementWorkCount();
-      });
-}
-
 void DecrementWorkCount() {
   g_scheduler->DecrementWorkCount();
 }
@@ -397,10 +392,11 @@ Setup::Setup()
       dotfile_scope_(&dotfile_settings_) {
   dotfile_settings_.set_toolchain_label(Label());
 
+  builder_.set_resolve_targets_on_worker_pool(true);
+
   build_settings_.set_item_defined_callback(
-      [task_runner = scheduler_.task_runner(),
-       builder = &builder_](std::unique_ptr<Item> item) {
-        ItemDefinedCallback(task_runner, builder, std::move(item));
+      [builder = &builder_](std::unique_ptr<Item> item) {
+        builder->ItemDefinedOnAnyThread(std::move(item));
       });
 
   loader_->set_complete_callback(&DecrementWorkCount);
@@ -1141,6 +1137,34 @@ bool Setup::FillOtherConfig(const base::CommandLine& cmdline, Err* err) {
     build_settings_.set_no_stamp_files(no_stamp_files_value->boolean_value());
   }
 
+  // Shared flag sets.
+  const Value* shared_flag_sets_value =
+      dotfile_scope_.GetValue("ninja_shared_flag_sets", true);
+  if (shared_flag_sets_value) {
+    if (!shared_flag_sets_value->VerifyTypeIs(Value::BOOLEAN, err)) {
+      return false;
+    }
+    build_settings_.set_ninja_shared_flag_sets(
+        shared_flag_sets_value->boolean_value());
+  }
+
+  // Target shards.
+  const Value* target_shards_value =
+      dotfile_scope_.GetValue("ninja_target_shards", true);
+  if (target_shards_value) {
+    if (!target_shards_value->VerifyTypeIs(Value::INTEGER, err)) {
+      return false;
+    }
+    if (target_shards_value->int_value() < 0 ||
+        target_shards_value->int_value() > 65536) {
+      *err = Err(*target_shards_value, "Invalid ninja_target_shards.",
+                 "It must be between 0 and 65536.");
+      return false;
+    }
+    build_settings_.set_ninja_target_shards(
+        static_cast<int>(target_shards_value->int_value()));
+  }
+
   // Export compile commands.
   const Value* export_cc_value =
       dotfile_scope_.GetValue("export_compile_commands", true);
@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 
+#include "base/hash.h"
 #include "gn/hash_table_base.h"
 
 namespace {
@@ -75,10 +76,8 @@ struct KeySet : public HashTableBase<KeyNode> {
   using BaseType = HashTableBase<KeyNode>;
   using Node = BaseType::Node;
 
-  // Compute hash for |str|. Replace with faster hash function if available.
-  static size_t Hash(std::string_view str) {
-    return std::hash<std::string_view>()(str);
-  }
+  // Compute hash for |str|.
+  static size_t Hash(std::string_view str) { return base::FastHash(str); }
 
   // Lookup for |str| with specific |hash| value.
   // Return a Node pointer. If the key was found, |node.key| is its value.
@@ -9,6 +9,8 @@
 #include <string>
 #include <string_view>
 
+#include "base/hash.h"
+
 // A StringAtom models a pointer to a globally unique constant string.
 //
 // They are useful as key types for sets and map container types, especially
@@ -117,7 +119,7 @@ class StringAtom {
     return value_ < other.value_;
   }
 
-  size_t hash() const { return std::hash<std::string>()(value_); }
+  size_t hash() const { return base::FastHash(value_); }
 
   // Use the following method and structs to implement containers that
   // use StringAtom values as keys, but only compare/hash the pointer
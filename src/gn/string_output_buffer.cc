@@ -51,6 +51,14 @@ void StringOutputBuffer::Append(char c) {
   pos_ += 1;
 }
 
+void StringOutputBuffer::Append(const StringOutputBuffer& other) {
+  size_t data_size = other.size();
+  for (size_t nn = 0; nn < other.pages_.size(); ++nn) {
+    size_t wanted_size = std::min(kPageSize, data_size - nn * kPageSize);
+    Append(std::string_view(other.pages_[nn]->data(), wanted_size));
+  }
+}
+
 bool StringOutputBuffer::ContentsEqual(const base::FilePath& file_path) const {
   // Compare file and stream sizes first. Quick and will save us some time if
   // they are different sizes.
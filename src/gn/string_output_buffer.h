@@ -55,6 +55,9 @@ class StringOutputBuffer : public std::streambuf {
   void Append(std::string_view str);
   void Append(char c);
 
+  // Append the content of another instance to this one.
+  void Append(const StringOutputBuffer& other);
+
   StringOutputBuffer& operator<<(std::string_view str) {
     Append(str);
     return *this;
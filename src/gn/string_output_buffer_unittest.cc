@@ -61,6 +61,26 @@ TEST(StringOutputBuffer, AppendWithPageSizeMultiples) {
   ASSERT_STREQ(data.c_str(), buffer.str().c_str());
 }
 
+TEST(StringOutputBuffer, AppendBuffer) {
+  const size_t page_size = StringOutputBuffer::GetPageSizeForTesting();
+  std::string data = CreateTestString(page_size * 3 + 100);
+
+  // Split so that neither part is page-aligned.
+  const size_t split = page_size + 10;
+  StringOutputBuffer first;
+  first.Append(data.data(), split);
+  StringOutputBuffer second;
+  second.Append(data.data() + split, data.size() - split);
+
+  first.Append(second);
+  EXPECT_EQ(data.size(), first.size());
+  ASSERT_STREQ(data.c_str(), first.str().c_str());
+
+  // Appending an empty buffer is a no-op.
+  first.Append(StringOutputBuffer());
+  EXPECT_EQ(data.size(), first.size());
+}
+
 TEST(StringOutput, WrappedByStdOstream) {
   const size_t data_size = 100000;
   std::string data = CreateTestString(data_size);
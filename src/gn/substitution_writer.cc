@@ -4,6 +4,11 @@
 
 #include "gn/substitution_writer.h"
 
+#include <algorithm>
+#include <string_view>
+
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
 #include "gn/build_settings.h"
 #include "gn/c_substitution_type.h"
 #include "gn/escape.h"
@@ -221,6 +226,8 @@ std::string SubstitutionWriter::ApplyPatternToSourceAsString(
     const Settings* settings,
     const SubstitutionPattern& pattern,
     const SourceFile& source) {
+  // Compiling the pattern only pays off when applying it to many sources, see
+  // CompiledSubstitutionPattern.
   std::string result_value;
   for (const auto& subrange : pattern.ranges()) {
     if (subrange.type == &SubstitutionLiteral) {
@@ -287,8 +294,12 @@ void SubstitutionWriter::ApplyListToSources(
     const std::vector<SourceFile>& sources,
     std::vector<SourceFile>* output) {
   output->clear();
-  for (const auto& source : sources)
-    ApplyListToSource(target, settings, list, source, output);
+  std::vector<CompiledSubstitutionPattern> patterns =
+      CompiledSubstitutionPattern::CompileList(target, settings, list);
+  for (const auto& source : sources) {
+    for (const auto& pattern : patterns)
+      output->push_back(pattern.ApplyToSource(source));
+  }
 }
 
 // static
@@ -299,8 +310,12 @@ void SubstitutionWriter::ApplyListToSourcesAsString(
     const std::vector<SourceFile>& sources,
     std::vector<std::string>* output) {
   output->clear();
-  for (const auto& source : sources)
-    ApplyListToSourceAsString(target, settings, list, source, output);
+  std::vector<CompiledSubstitutionPattern> patterns =
+      CompiledSubstitutionPattern::CompileList(target, settings, list);
+  for (const auto& source : sources) {
+    for (const auto& pattern : patterns)
+      pattern.AppendForSource(source, &output->emplace_back());
+  }
 }
 
 // static
@@ -311,8 +326,12 @@ void SubstitutionWriter::ApplyListToSourcesAsOutputFile(
     const std::vector<SourceFile>& sources,
     std::vector<OutputFile>* output) {
   output->clear();
-  for (const auto& source : sources)
-    ApplyListToSourceAsOutputFile(target, settings, list, source, output);
+  std::vector<CompiledSubstitutionPattern> patterns =
+      CompiledSubstitutionPattern::CompileList(target, settings, list);
+  for (const auto& source : sources) {
+    for (const auto& pattern : patterns)
+      output->push_back(pattern.ApplyToSourceAsOutputFile(source));
+  }
 }
 
 // static
@@ -340,6 +359,39 @@ void SubstitutionWriter::WriteNinjaVariablesForSource(
   }
 }
 
+// static
+std::vector<CompiledSubstitutionPattern>
+SubstitutionWriter::CompileNinjaVariablesForSource(
+    const Target* target,
+    const Settings* settings,
+    const std::vector<const Substitution*>& types) {
+  std::vector<CompiledSubstitutionPattern> result;
+  for (const auto& type : types) {
+    // See WriteNinjaVariablesForSource() above for the skipped types.
+    if (type != &SubstitutionSource && type != &SubstitutionRspFileName) {
+      result.emplace_back(target, settings, type, OUTPUT_RELATIVE,
+                          settings->build_settings()->build_dir());
+    }
+  }
+  return result;
+}
+
+// static
+void SubstitutionWriter::WriteNinjaVariablesForSource(
+    const std::vector<CompiledSubstitutionPattern>& variables,
+    const SourceFile& source,
+    const EscapeOptions& escape_options,
+    std::ostream& out) {
+  std::string value;
+  for (const auto& variable : variables) {
+    out << "  " << variable.type()->ninja_name << " = ";
+    value.clear();
+    variable.AppendForSource(source, &value);
+    EscapeStringToStream(out, value, escape_options);
+    out << std::endl;
+  }
+}
+
 // static
 std::string SubstitutionWriter::GetSourceSubstitution(
     const Target* target,
@@ -585,3 +637,194 @@ std::string SubstitutionWriter::GetLinkerSubstitution(
     return std::string();
   }
 }
+
+CompiledSubstitutionPattern::CompiledSubstitutionPattern(
+    const Target* target,
+    const Settings* settings,
+    const SubstitutionPattern& pattern,
+    SubstitutionWriter::OutputStyle output_style,
+    const SourceDir& relative_to)
+    : target_(target),
+      settings_(settings),
+      output_style_(output_style),
+      relative_to_(relative_to),
+      pattern_(&pattern) {
+  for (const auto& subrange : pattern.ranges())
+    AddSegment(subrange.type, subrange.literal);
+}
+
+CompiledSubstitutionPattern::CompiledSubstitutionPattern(
+    const Target* target,
+    const Settings* settings,
+    const Substitution* type,
+    SubstitutionWriter::OutputStyle output_style,
+    const SourceDir& relative_to)
+    : target_(target),
+      settings_(settings),
+      output_style_(output_style),
+      relative_to_(relative_to),
+      type_(type) {
+  AddSegment(type, std::string());
+}
+
+CompiledSubstitutionPattern::CompiledSubstitutionPattern(
+    CompiledSubstitutionPattern&&) = default;
+
+CompiledSubstitutionPattern::~CompiledSubstitutionPattern() = default;
+
+// static
+std::vector<CompiledSubstitutionPattern>
+CompiledSubstitutionPattern::CompileList(const Target* target,
+                                         const Settings* settings,
+                                         const SubstitutionList& list) {
+  std::vector<CompiledSubstitutionPattern> result;
+  result.reserve(list.list().size());
+  for (const auto& pattern : list.list())
+    result.emplace_back(target, settings, pattern);
+  return result;
+}
+
+void CompiledSubstitutionPattern::AppendForSource(const SourceFile& source,
+                                                  std::string* out) const {
+  for (const auto& segment : segments_)
+    AppendSegment(segment, source, out);
+}
+
+SourceFile CompiledSubstitutionPattern::ApplyToSource(
+    const SourceFile& source) const {
+  std::string result_value;
+  AppendForSource(source, &result_value);
+  CHECK(!result_value.empty() && result_value[0] == '/')
+      << "The result of the pattern \""
+      << (pattern_ ? pattern_->AsString() : std::string(type_->name))
+      << "\" was not a path beginning in \"/\" or \"//\".";
+  return SourceFile(std::move(result_value));
+}
+
+OutputFile CompiledSubstitutionPattern::ApplyToSourceAsOutputFile(
+    const SourceFile& source) const {
+  return OutputFile(settings_->build_settings(), ApplyToSource(source));
+}
+
+void CompiledSubstitutionPattern::AddSegment(const Substitution* type,
+                                             const std::string& literal) {
+  if (type == &SubstitutionLiteral) {
+    if (!segments_.empty() && segments_.back().kind == SEGMENT_LITERAL) {
+      segments_.back().literal.append(literal);
+      return;
+    }
+    Segment& segment = segments_.emplace_back();
+    segment.kind = SEGMENT_LITERAL;
+    segment.type = type;
+    segment.literal = literal;
+    return;
+  }
+
+  // This mirrors the cases of SubstitutionWriter::GetSourceSubstitution().
+  SegmentKind kind;
+  bool absolute = output_style_ == SubstitutionWriter::OUTPUT_ABSOLUTE;
+  if (type == &SubstitutionSource) {
+    kind = absolute ? SEGMENT_SOURCE : SEGMENT_REBASED_PATH;
+  } else if (type == &SubstitutionSourceNamePart) {
+    kind = SEGMENT_SOURCE_NAME_PART;
+  } else if (type == &SubstitutionSourceFilePart) {
+    kind = SEGMENT_SOURCE_FILE_PART;
+  } else if (type == &SubstitutionSourceDir ||
+             type == &SubstitutionSourceRootRelativeDir ||
+             type == &SubstitutionSourceGenDir ||
+             type == &SubstitutionSourceOutDir) {
+    kind = SEGMENT_DIR_VALUE;
+  } else if (type == &SubstitutionSourceTargetRelative) {
+    kind = target_ ? SEGMENT_REBASED_PATH : SEGMENT_OTHER;
+  } else if (IsValidRustSubstitution(type)) {
+    kind = absolute ? SEGMENT_SOURCE : SEGMENT_REBASED_PATH;
+  } else {
+    kind = SEGMENT_OTHER;
+  }
+  Segment& segment = segments_.emplace_back();
+  segment.kind = kind;
+  segment.type = type;
+  if (kind == SEGMENT_REBASED_PATH) {
+    // Rebasing compares the components of the source path with the ones of
+    // the destination, and of the source root when it needs to go through
+    // it.
+    for (std::string_view path :
+         {std::string_view(GetRebaseDir(segment).value()),
+          std::string_view(settings_->build_settings()->root_path_utf8())}) {
+      for (std::string_view component : base::SplitStringPiece(
+               path, "/\\", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY))
+        segment.rebase_components.push_back(component);
+    }
+  }
+}
+
+void CompiledSubstitutionPattern::AppendSegment(const Segment& segment,
+                                                const SourceFile& source,
+                                                std::string* out) const {
+  const std::string& path = source.value();
+  switch (segment.kind) {
+    case SEGMENT_LITERAL:
+      out->append(segment.literal);
+      return;
+    case SEGMENT_SOURCE:
+      out->append(path);
+      return;
+    case SEGMENT_SOURCE_NAME_PART:
+      out->append(FindFilenameNoExtension(&path));
+      return;
+    case SEGMENT_SOURCE_FILE_PART:
+      out->append(FindFilename(&path));
+      return;
+    case SEGMENT_DIR_VALUE:
+    case SEGMENT_REBASED_PATH:
+    case SEGMENT_OTHER:
+      break;
+  }
+
+  // The rebased path is the rebased directory followed by the file name, so
+  // the rebased directory can be reused for the other files of the
+  // directory. This doesn't hold for a file with the same name as a directory
+  // the path is rebased through, so those are always computed from scratch.
+  std::string_view dir = FindDir(&path);
+  std::string_view name = FindFilename(&path);
+  // Components are compared case-insensitively on some platforms.
+  bool cacheable =
+      segment.kind == SEGMENT_DIR_VALUE ||
+      (segment.kind == SEGMENT_REBASED_PATH &&
+       std::none_of(segment.rebase_components.begin(),
+                    segment.rebase_components.end(),
+                    [name](std::string_view component) {
+                      return base::EqualsCaseInsensitiveASCII(component, name);
+                    }));
+  if (cacheable && segment.has_cached_value && segment.cached_dir == dir) {
+    out->append(segment.cached_value);
+    if (segment.kind == SEGMENT_REBASED_PATH)
+      out->append(name);
+    return;
+  }
+
+  std::string value = SubstitutionWriter::GetSourceSubstitution(
+      target_, settings_, source, segment.type, output_style_, relative_to_);
+  if (segment.kind == SEGMENT_DIR_VALUE) {
+    segment.cached_dir.assign(dir);
+    segment.cached_value = value;
+    segment.has_cached_value = true;
+  } else if (cacheable) {
+    if (value.size() >= name.size() &&
+        std::string_view(value).substr(value.size() - name.size()) == name) {
+      segment.cached_dir.assign(dir);
+      segment.cached_value.assign(value, 0, value.size() - name.size());
+      segment.has_cached_value = true;
+    } else {
+      segment.has_cached_value = false;
+    }
+  }
+  out->append(value);
+}
+
+const SourceDir& CompiledSubstitutionPattern::GetRebaseDir(
+    const Segment& segment) const {
+  if (segment.type == &SubstitutionSourceTargetRelative)
+    return target_->label().dir();
+  return relative_to_;
+}
@@ -7,14 +7,16 @@
 
 #include <iosfwd>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "gn/source_dir.h"
 #include "gn/substitution_type.h"
 
+class CompiledSubstitutionPattern;
 struct EscapeOptions;
 class OutputFile;
 class Settings;
-class SourceDir;
 class SourceFile;
 class SubstitutionList;
 class SubstitutionPattern;
@@ -159,6 +161,19 @@ class SubstitutionWriter {
       const EscapeOptions& escape_options,
       std::ostream& out);
 
+  // Compiles the given source substitution types for writing them with the
+  // WriteNinjaVariablesForSource() overload below, when writing the variables
+  // for many sources of a target.
+  static std::vector<CompiledSubstitutionPattern>
+  CompileNinjaVariablesForSource(const Target* target,
+                                 const Settings* settings,
+                                 const std::vector<const Substitution*>& types);
+  static void WriteNinjaVariablesForSource(
+      const std::vector<CompiledSubstitutionPattern>& variables,
+      const SourceFile& source,
+      const EscapeOptions& escape_options,
+      std::ostream& out);
+
   // Extracts the given type of substitution related to a source file from the
   // given source file. If output_style is OUTPUT_RELATIVE, relative_to
   // indicates the directory that the relative directories should be relative
@@ -235,4 +250,109 @@ class SubstitutionWriter {
                                            const Substitution* type);
 };
 
+// A SubstitutionPattern prepared for applying it to many source files of the
+// same target, as done for the outputs and args of action_foreach and copy
+// targets. It gives the same results as the SubstitutionWriter source
+// functions.
+//
+// Consecutive literals are joined when compiling the pattern. The file name
+// parts of a source are appended as slices of its path. The substitutions that
+// need rebasing are only computed once per source directory, which is
+// remembered from the previous call since sources are usually grouped by
+// directory. Because of this cache, an instance must not be used by several
+// threads at the same time.
+class CompiledSubstitutionPattern {
+ public:
+  // The target can be null (see SubstitutionWriter comment above).
+  // If |output_style| is OUTPUT_RELATIVE, directories are made relative to
+  // |relative_to|.
+  CompiledSubstitutionPattern(
+      const Target* target,
+      const Settings* settings,
+      const SubstitutionPattern& pattern,
+      SubstitutionWriter::OutputStyle output_style =
+          SubstitutionWriter::OUTPUT_ABSOLUTE,
+      const SourceDir& relative_to = SourceDir());
+
+  // Compiles a pattern consisting of the single given source substitution.
+  CompiledSubstitutionPattern(const Target* target,
+                              const Settings* settings,
+                              const Substitution* type,
+                              SubstitutionWriter::OutputStyle output_style,
+                              const SourceDir& relative_to);
+
+  CompiledSubstitutionPattern(CompiledSubstitutionPattern&&);
+  ~CompiledSubstitutionPattern();
+
+  // Compiles each pattern of the list, for use with source paths.
+  static std::vector<CompiledSubstitutionPattern> CompileList(
+      const Target* target,
+      const Settings* settings,
+      const SubstitutionList& list);
+
+  // The substitution for patterns compiled from a single substitution type,
+  // null otherwise.
+  const Substitution* type() const { return type_; }
+
+  // Appends the pattern applied to |source| to |out|.
+  void AppendForSource(const SourceFile& source, std::string* out) const;
+
+  // Like SubstitutionWriter::ApplyPatternToSource() and
+  // ApplyPatternToSourceAsOutputFile().
+  SourceFile ApplyToSource(const SourceFile& source) const;
+  OutputFile ApplyToSourceAsOutputFile(const SourceFile& source) const;
+
+ private:
+  enum SegmentKind {
+    SEGMENT_LITERAL,
+    SEGMENT_SOURCE,            // The full source path, as is.
+    SEGMENT_SOURCE_NAME_PART,  // The file name without extension.
+    SEGMENT_SOURCE_FILE_PART,  // The file name.
+    SEGMENT_DIR_VALUE,         // Only depends on the source directory.
+    SEGMENT_REBASED_PATH,      // The rebased source path.
+    SEGMENT_OTHER,             // Computed for each source.
+  };
+
+  struct Segment {
+    SegmentKind kind = SEGMENT_LITERAL;
+    const Substitution* type = nullptr;
+    std::string literal;
+
+    // Directory of the last source for SEGMENT_DIR_VALUE and
+    // SEGMENT_REBASED_PATH, and the value or the rebased directory prefix
+    // computed for it.
+    mutable std::string cached_dir;
+    mutable std::string cached_value;
+    mutable bool has_cached_value = false;
+
+    // For SEGMENT_REBASED_PATH, the path components that the file name is
+    // compared with when rebasing.
+    std::vector<std::string_view> rebase_components;
+  };
+
+  // Appends the segment for the given substitution or literal, joining
+  // consecutive literals.
+  void AddSegment(const Substitution* type, const std::string& literal);
+
+  // Appends the value of the given segment for |source|.
+  void AppendSegment(const Segment& segment,
+                     const SourceFile& source,
+                     std::string* out) const;
+
+  // Returns the directory the path is rebased to for SEGMENT_REBASED_PATH.
+  const SourceDir& GetRebaseDir(const Segment& segment) const;
+
+  const Target* target_;
+  const Settings* settings_;
+  SubstitutionWriter::OutputStyle output_style_;
+  SourceDir relative_to_;
+  const SubstitutionPattern* pattern_ = nullptr;  // For error messages.
+  const Substitution* type_ = nullptr;
+  std::vector<Segment> segments_;
+
+  CompiledSubstitutionPattern(const CompiledSubstitutionPattern&) = delete;
+  CompiledSubstitutionPattern& operator=(const CompiledSubstitutionPattern&) =
+      delete;
+};
+
 #endif  // TOOLS_GN_SUBSTITUTION_WRITER_H_
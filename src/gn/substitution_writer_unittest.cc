@@ -66,6 +66,71 @@ TEST(SubstitutionWriter, ApplyPatternToSourceAsOutputFile) {
   ASSERT_EQ("gen/foo/bar/myfile.tmp", result.value());
 }
 
+TEST(SubstitutionWriter, CompiledSubstitutionPattern) {
+  TestWithScope setup;
+  Err err;
+
+  Target target(setup.settings(), Label(SourceDir("//foo/bar/"), "baz"));
+  target.set_output_type(Target::STATIC_LIBRARY);
+  target.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(target.OnResolved(&err));
+
+  // Sources sharing directories, so that cached values get reused, and files
+  // named like a directory of the build dir or of the target dir, whose
+  // rebased paths don't end with their name.
+  const char* const kSources[] = {
+      "//foo/bar/a.txt", "//foo/bar/b.txt", "//foo/c.txt", "//out/Debug",
+      "//out/Release",   "//out/Debug",     "//foo/bar",   "//foo/baz",
+      "/abs/d.txt",      "/abs/e.txt",      "//foo/bar/a.txt",
+  };
+  const Substitution* const kTypes[] = {
+      &SubstitutionSource,
+      &SubstitutionSourceNamePart,
+      &SubstitutionSourceFilePart,
+      &SubstitutionSourceDir,
+      &SubstitutionSourceRootRelativeDir,
+      &SubstitutionSourceGenDir,
+      &SubstitutionSourceOutDir,
+      &SubstitutionSourceTargetRelative,
+  };
+  const SourceDir& build_dir = setup.settings()->build_settings()->build_dir();
+  for (const Substitution* type : kTypes) {
+    CompiledSubstitutionPattern relative(&target, setup.settings(), type,
+                                         SubstitutionWriter::OUTPUT_RELATIVE,
+                                         build_dir);
+    CompiledSubstitutionPattern absolute(&target, setup.settings(), type,
+                                         SubstitutionWriter::OUTPUT_ABSOLUTE,
+                                         SourceDir());
+    for (const char* source : kSources) {
+      std::string value;
+      relative.AppendForSource(SourceFile(source), &value);
+      EXPECT_EQ(SubstitutionWriter::GetSourceSubstitution(
+                    &target, setup.settings(), SourceFile(source), type,
+                    SubstitutionWriter::OUTPUT_RELATIVE, build_dir),
+                value)
+          << type->name << " " << source;
+      value.clear();
+      absolute.AppendForSource(SourceFile(source), &value);
+      EXPECT_EQ(SubstitutionWriter::GetSourceSubstitution(
+                    &target, setup.settings(), SourceFile(source), type,
+                    SubstitutionWriter::OUTPUT_ABSOLUTE, SourceDir()),
+                value)
+          << type->name << " " << source;
+    }
+  }
+
+  SubstitutionPattern pattern;
+  ASSERT_TRUE(pattern.Parse(
+      "{{source_gen_dir}}/{{source_name_part}}.tmp/{{source_file_part}}",
+      nullptr, &err));
+  CompiledSubstitutionPattern compiled(&target, setup.settings(), pattern);
+  EXPECT_EQ("//out/Debug/gen/foo/bar/a.tmp/a.txt",
+            compiled.ApplyToSource(SourceFile("//foo/bar/a.txt")).value());
+  EXPECT_EQ("gen/foo/bar/b.tmp/b.txt",
+            compiled.ApplyToSourceAsOutputFile(SourceFile("//foo/bar/b.txt"))
+                .value());
+}
+
 TEST(SubstitutionWriter, WriteNinjaVariablesForSource) {
   TestWithScope setup;
 
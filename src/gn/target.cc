@@ -16,6 +16,7 @@
 #include "gn/deps_iterator.h"
 #include "gn/filesystem_utils.h"
 #include "gn/functions.h"
+#include "gn/label_pattern_matcher.h"
 #include "gn/rust_tool.h"
 #include "gn/scheduler.h"
 #include "gn/substitution_writer.h"
@@ -162,6 +163,7 @@ bool EnsureFileIsGeneratedByDependency(const Target* target,
 bool RecursiveCheckAssertNoDeps(const Target* target,
                                 bool check_this,
                                 const std::vector<LabelPattern>& assert_no,
+                                const LabelPatternMatcher& assert_no_matcher,
                                 TargetSet* visited,
                                 std::string* failure_path_str,
                                 const LabelPattern** failure_pattern) {
@@ -170,24 +172,24 @@ bool RecursiveCheckAssertNoDeps(const Target* target,
   if (!visited->add(target))
     return true;  // Already checked this target.
 
-  if (check_this) {
-    // Check this target against the given list of patterns.
+  if (check_this && assert_no_matcher.Matches(target->label())) {
+    // Found a match, find the pattern responsible for it.
     for (const LabelPattern& pattern : assert_no) {
       if (pattern.Matches(target->label())) {
-        // Found a match.
         *failure_pattern = &pattern;
-        *failure_path_str =
-            kIndentPath + target->label().GetUserVisibleName(false);
-        return false;
+        break;
       }
     }
+    *failure_path_str = kIndentPath + target->label().GetUserVisibleName(false);
+    return false;
   }
 
   // Recursively check dependencies.
   for (const auto& pair : target->GetDeps(Target::DEPS_ALL)) {
     if (pair.ptr->output_type() == Target::EXECUTABLE)
       continue;
-    if (!RecursiveCheckAssertNoDeps(pair.ptr, true, assert_no, visited,
+    if (!RecursiveCheckAssertNoDeps(pair.ptr, true, assert_no,
+                                    assert_no_matcher, visited,
                                     failure_path_str, failure_pattern)) {
       // To reconstruct the path, prepend the current target to the error.
       std::string prepend_path =
@@ -553,7 +555,7 @@ bool Target::ShouldGenerate() const {
     // By default, generate all targets that belong to the default toolchain.
     return settings()->is_default();
   }
-  return LabelPattern::VectorMatches(root_patterns, label());
+  return settings()->build_settings()->root_patterns_matcher().Matches(label());
 }
 
 DepsIteratorRange Target::GetDeps(DepsIterationType type) const {
@@ -1099,7 +1101,9 @@ bool Target::CheckAssertNoDeps(Err* err) const {
   std::string failure_path_str;
   const LabelPattern* failure_pattern = nullptr;
 
-  if (!RecursiveCheckAssertNoDeps(this, false, assert_no_deps_, &visited,
+  LabelPatternMatcher assert_no_matcher(assert_no_deps_);
+  if (!RecursiveCheckAssertNoDeps(this, false, assert_no_deps_,
+                                  assert_no_matcher, &visited,
                                   &failure_path_str, &failure_pattern)) {
     *err = Err(
         defined_from(), "assert_no_deps failed.",
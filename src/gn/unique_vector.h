@@ -10,6 +10,9 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "hash_table_base.h"
@@ -71,12 +74,19 @@ class UniqueVectorHashSet : public UniqueVectorHashTableBase {
     BaseType::UpdateAfterInsert();
   }
 
+  // Grow the table so that |count| items can be inserted without resizing.
+  void Reserve(size_t count) { NodeReserve(count); }
+
   void Clear() { NodeClear(); }
 };
 
 // An ordered set optimized for GN's usage. Such sets are used to store lists
 // of configs and libraries, and are appended to but not randomly inserted
 // into.
+//
+// Most of these sets only ever contain a few items, so items are looked up by
+// a linear scan of the vector until there are more than kMaxLinearSize of
+// them. Only then are they hashed and indexed by a hash table.
 template <typename T,
           typename Hash = std::hash<T>,
           typename EqualTo = std::equal_to<T>>
@@ -86,6 +96,9 @@ class UniqueVector {
   using iterator = typename Vector::iterator;
   using const_iterator = typename Vector::const_iterator;
 
+  // Maximum number of items looked up without a hash table.
+  static constexpr size_t kMaxLinearSize = 8;
+
   const Vector& vector() const { return vector_; }
   size_t size() const { return vector_.size(); }
   bool empty() const { return vector_.empty(); }
@@ -93,7 +106,11 @@ class UniqueVector {
     vector_.clear();
     set_.Clear();
   }
-  void reserve(size_t s) { vector_.reserve(s); }
+  void reserve(size_t s) {
+    vector_.reserve(s);
+    if (s > kMaxLinearSize)
+      set_.Reserve(s);
+  }
 
   const T& operator[](size_t index) const { return vector_[index]; }
 
@@ -109,28 +126,10 @@ class UniqueVector {
 
   // Returns true if the item was appended, false if it already existed (and
   // thus the vector was not modified).
-  bool push_back(const T& t) {
-    size_t hash;
-    auto* node = Lookup(t, &hash);
-    if (node->is_valid()) {
-      return false;  // Already have this one.
-    }
-    vector_.push_back(t);
-    set_.Insert(node, hash, vector_.size() - 1);
-    return true;
-  }
+  bool push_back(const T& t) { return PushBackWithIndex(t).first; }
 
   // Same as above, but moves the item into the vector if possible.
-  bool push_back(T&& t) {
-    size_t hash = Hash()(t);
-    auto* node = Lookup(t, &hash);
-    if (node->is_valid()) {
-      return false;  // Already have this one.
-    }
-    vector_.push_back(std::move(t));
-    set_.Insert(node, hash, vector_.size() - 1);
-    return true;
-  }
+  bool push_back(T&& t) { return PushBackWithIndex(std::move(t)).first; }
 
   // Construct an item in-place if possible. Return true if it was
   // appended, false otherwise.
@@ -145,28 +144,24 @@ class UniqueVector {
   // kIndexNone. This can be used to implement a map using a
   // UniqueVector<> for keys, and a parallel array for values.
   std::pair<bool, size_t> PushBackWithIndex(const T& t) {
-    size_t hash;
-    auto* node = Lookup(t, &hash);
-    if (node->is_valid()) {
-      return {false, node->index()};
-    }
-    size_t result = vector_.size();
+    size_t hash = 0;
+    UniqueVectorNode* node;
+    size_t index = Find(t, &hash, &node);
+    if (index != kIndexNone)
+      return {false, index};
     vector_.push_back(t);
-    set_.Insert(node, hash, result);
-    return {true, result};
+    return {true, Insert(hash, node)};
   }
 
   // Same as above, but moves the item into the set on success.
   std::pair<bool, size_t> PushBackWithIndex(T&& t) {
-    size_t hash;
-    auto* node = Lookup(t, &hash);
-    if (node->is_valid()) {
-      return {false, node->index()};
-    }
-    size_t result = vector_.size();
+    size_t hash = 0;
+    UniqueVectorNode* node;
+    size_t index = Find(t, &hash, &node);
+    if (index != kIndexNone)
+      return {false, index};
     vector_.push_back(std::move(t));
-    set_.Insert(node, hash, result);
-    return {true, result};
+    return {true, Insert(hash, node)};
   }
 
   // Construct an item in-place if possible. If a corresponding
@@ -179,9 +174,12 @@ class UniqueVector {
     return PushBackWithIndex(T{std::forward<ARGS>(args)...});
   }
 
-  // Appends a range of items from an iterator.
+  // Appends a range of items from an iterator. When the size of the range is
+  // known, the vector and the hash table are sized for all of the items
+  // first, so they are merged without intermediate reallocations.
   template <typename iter>
   void Append(const iter& begin, const iter& end) {
+    ReserveForAppend(begin, end);
     for (iter i = begin; i != end; ++i)
       push_back(*i);
   }
@@ -204,30 +202,81 @@ class UniqueVector {
                 decltype(static_cast<T>(*std::declval<C>().begin())),
                 decltype(static_cast<T>(*std::declval<C>().end()))>>
   void Append(C&& other) {
+    ReserveForAppend(other.begin(), other.end());
     for (auto it = other.begin(); it != other.end(); ++it)
       push_back(std::move(*it));
   }
 
   // Returns true if the item is already in the vector.
-  bool Contains(const T& t) const {
-    size_t hash;
-    return Lookup(t, &hash)->is_valid();
-  }
+  bool Contains(const T& t) const { return IndexOf(t) != kIndexNone; }
 
   // Returns the index of the item matching the given value in the list, or
   // kIndexNone if it's not found.
   size_t IndexOf(const T& t) const {
-    size_t hash;
-    return Lookup(t, &hash)->index();
+    size_t hash = 0;
+    UniqueVectorNode* node;
+    return Find(t, &hash, &node);
   }
 
   static constexpr size_t kIndexNone = 0xffffffffu;
 
  private:
-  // Lookup hash set node for item |t|, also sets |*hash| to the hash value.
-  UniqueVectorNode* Lookup(const T& t, size_t* hash) const {
+  // The hash table is only populated once there are more than
+  // kMaxLinearSize items.
+  bool UsesHashTable() const { return !set_.empty(); }
+
+  // Returns the index of item |t|, or kIndexNone if it is not in the vector.
+  // If the hash table is in use, also sets |*hash| to the item's hash value
+  // and |*node| to the hash set node to pass to Insert(), otherwise |*node|
+  // is set to nullptr.
+  size_t Find(const T& t, size_t* hash, UniqueVectorNode** node) const {
+    if (!UsesHashTable()) {
+      *node = nullptr;
+      for (size_t i = 0; i < vector_.size(); i++) {
+        if (EqualTo()(vector_[i], t))
+          return i;
+      }
+      return kIndexNone;
+    }
     *hash = Hash()(t);
-    return set_.Lookup<T, EqualTo>(*hash, t, vector_);
+    *node = set_.Lookup<T, EqualTo>(*hash, t, vector_);
+    return (*node)->is_valid() ? (*node)->index() : kIndexNone;
+  }
+
+  // Indexes the item that was just appended to the vector after a
+  // Find() call that returned |hash| and |node|, and returns its index.
+  size_t Insert(size_t hash, UniqueVectorNode* node) {
+    size_t index = vector_.size() - 1;
+    if (node) {
+      set_.Insert(node, hash, index);
+    } else if (vector_.size() > kMaxLinearSize) {
+      // Switch to the hash table, indexing all items.
+      set_.Reserve(vector_.size());
+      for (size_t i = 0; i < vector_.size(); i++) {
+        size_t item_hash = Hash()(vector_[i]);
+        set_.Insert(set_.Lookup<T, EqualTo>(item_hash, vector_[i], vector_),
+                    item_hash, i);
+      }
+    }
+    return index;
+  }
+
+  // Sizes the vector and the hash table for appending the items from |begin|
+  // to |end|, if their number is known without iterating over them. The
+  // vector still grows geometrically, since sets are often built by many
+  // small appends. The hash table is only sized if it is already in use,
+  // since appended items are often duplicates.
+  template <typename iter>
+  void ReserveForAppend(const iter& begin, const iter& end) {
+    if constexpr (std::is_base_of_v<
+                      std::forward_iterator_tag,
+                      typename std::iterator_traits<iter>::iterator_category>) {
+      size_t count = vector_.size() + std::distance(begin, end);
+      if (count > vector_.capacity())
+        vector_.reserve(std::max(count, vector_.capacity() * 2));
+      if (UsesHashTable())
+        set_.Reserve(count);
+    }
   }
 
   Vector vector_;
@@ -7,6 +7,9 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
 
 #include "util/test/test.h"
 
@@ -126,3 +129,57 @@ TEST(UniqueVector, Release) {
   EXPECT_EQ(std::string("b"), v[1]);
   EXPECT_EQ(std::string("c"), v[2]);
 }
+
+TEST(UniqueVector, LinearAndHashedLookups) {
+  // Items are looked up linearly at first, then with the hash table.
+  constexpr int kCount = 3 * UniqueVector<int>::kMaxLinearSize;
+  UniqueVector<int> vect;
+  for (int i = 0; i < kCount; i++) {
+    EXPECT_FALSE(vect.Contains(i));
+    EXPECT_TRUE(vect.push_back(i));
+    for (int j = 0; j <= i; j++) {
+      EXPECT_FALSE(vect.push_back(j));
+      EXPECT_EQ(static_cast<size_t>(j), vect.IndexOf(j));
+    }
+    EXPECT_EQ(UniqueVector<int>::kIndexNone, vect.IndexOf(kCount));
+  }
+  EXPECT_EQ(static_cast<size_t>(kCount), vect.size());
+
+  UniqueVector<int> copy = vect;
+  EXPECT_FALSE(copy.push_back(kCount - 1));
+  EXPECT_TRUE(copy.push_back(kCount));
+  EXPECT_FALSE(vect.Contains(kCount));
+
+  vect.clear();
+  EXPECT_FALSE(vect.Contains(0));
+  EXPECT_TRUE(vect.push_back(0));
+  EXPECT_EQ(1u, vect.size());
+}
+
+TEST(UniqueVector, Append) {
+  UniqueVector<std::string> vect;
+  vect.push_back("a");
+  vect.push_back("b");
+
+  std::vector<std::string> more = {"b", "c", "a", "d", "e", "f",
+                                   "g", "h", "i", "c", "j"};
+  vect.Append(more.begin(), more.end());
+  std::vector<std::string> expected = {"a", "b", "c", "d", "e",
+                                       "f", "g", "h", "i", "j"};
+  EXPECT_EQ(expected, vect.vector());
+
+  std::list<std::string> list = {"k", "j", "l"};
+  vect.Append(std::move(list));
+  expected.push_back("k");
+  expected.push_back("l");
+  EXPECT_EQ(expected, vect.vector());
+  for (size_t i = 0; i < expected.size(); i++)
+    EXPECT_EQ(i, vect.IndexOf(expected[i]));
+
+  UniqueVector<std::string> other;
+  other.push_back("l");
+  other.push_back("m");
+  vect.Append(other);
+  expected.push_back("m");
+  EXPECT_EQ(expected, vect.vector());
+}
@@ -13,6 +13,7 @@
 #include "gn/filesystem_utils.h"
 #include "gn/item.h"
 #include "gn/label.h"
+#include "gn/label_pattern_matcher.h"
 #include "gn/scope.h"
 #include "gn/value.h"
 #include "gn/variables.h"
@@ -38,6 +39,7 @@ bool Visibility::Set(const SourceDir& current_dir,
     if (err->has_error())
       return false;
   }
+  UpdateMatcher();
   return true;
 }
 
@@ -45,15 +47,19 @@ void Visibility::SetPublic() {
   patterns_.clear();
   patterns_.push_back(LabelPattern(LabelPattern::RECURSIVE_DIRECTORY,
                                    SourceDir(), std::string(), Label()));
+  UpdateMatcher();
 }
 
 void Visibility::SetPrivate(const SourceDir& current_dir) {
   patterns_.clear();
   patterns_.push_back(LabelPattern(LabelPattern::DIRECTORY, current_dir,
                                    std::string(), Label()));
+  UpdateMatcher();
 }
 
 bool Visibility::CanSeeMe(const Label& label) const {
+  if (matcher_)
+    return matcher_->Matches(label);
   return LabelPattern::VectorMatches(patterns_, label);
 }
 
@@ -87,6 +93,13 @@ std::unique_ptr<base::Value> Visibility::AsValue() const {
   return res;
 }
 
+void Visibility::UpdateMatcher() {
+  if (patterns_.size() > LabelPatternMatcher::kMaxLinearPatterns)
+    matcher_ = std::make_unique<LabelPatternMatcher>(patterns_);
+  else
+    matcher_.reset();
+}
+
 // static
 bool Visibility::CheckItemVisibility(const Item* from,
                                      const Item* to,
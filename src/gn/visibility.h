@@ -19,6 +19,7 @@ class Value;
 class Err;
 class Item;
 class Label;
+class LabelPatternMatcher;
 class Scope;
 class Value;
 
@@ -54,6 +55,8 @@ class Visibility {
   // Returns value representation of this visibility
   std::unique_ptr<base::Value> AsValue() const;
 
+  const std::vector<LabelPattern>& patterns() const { return patterns_; }
+
   // Helper function to check visibility between the given two items. If
   // to is invisible to from, returns false and sets the error.
   static bool CheckItemVisibility(const Item* from, const Item* to, Err* err);
@@ -63,8 +66,16 @@ class Visibility {
   static bool FillItemVisibility(Item* item, Scope* scope, Err* err);
 
  private:
+  // Compiles |matcher_| from |patterns_| if there are enough patterns for it
+  // to be faster than checking them in turn.
+  void UpdateMatcher();
+
   std::vector<LabelPattern> patterns_;
 
+  // Compiled from patterns_, checked once for every dependent. Null for short
+  // lists, which are matched linearly.
+  std::unique_ptr<LabelPatternMatcher> matcher_;
+
   Visibility(const Visibility&) = delete;
   Visibility& operator=(const Visibility&) = delete;
 };
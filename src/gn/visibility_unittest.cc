@@ -31,6 +31,32 @@ TEST(Visibility, CanSeeMe) {
   EXPECT_FALSE(vis.CanSeeMe(Label(SourceDir("//directory/"), "anything")));
 }
 
+TEST(Visibility, CanSeeMeLongList) {
+  // Enough patterns to be matched by a compiled LabelPatternMatcher.
+  Value list(nullptr, Value::LIST);
+  list.list_value().push_back(Value(nullptr, "//rec/*"));
+  list.list_value().push_back(Value(nullptr, "//dir:*"));
+  list.list_value().push_back(Value(nullptr, "//my:name"));
+  for (int i = 0; i < 10; i++) {
+    list.list_value().push_back(
+        Value(nullptr, "//other" + std::to_string(i) + ":name"));
+  }
+
+  Err err;
+  Visibility vis;
+  ASSERT_TRUE(vis.Set(SourceDir("//"), std::string_view(), list, &err));
+
+  EXPECT_FALSE(vis.CanSeeMe(Label(SourceDir("//random/"), "thing")));
+  EXPECT_FALSE(vis.CanSeeMe(Label(SourceDir("//my/"), "notname")));
+  EXPECT_FALSE(vis.CanSeeMe(Label(SourceDir("//other1/"), "notname")));
+
+  EXPECT_TRUE(vis.CanSeeMe(Label(SourceDir("//my/"), "name")));
+  EXPECT_TRUE(vis.CanSeeMe(Label(SourceDir("//other9/"), "name")));
+  EXPECT_TRUE(vis.CanSeeMe(Label(SourceDir("//rec/a/"), "anything")));
+  EXPECT_TRUE(vis.CanSeeMe(Label(SourceDir("//dir/"), "anything")));
+  EXPECT_FALSE(vis.CanSeeMe(Label(SourceDir("//dir/a/"), "anything")));
+}
+
 TEST(Visibility, Public) {
   Err err;
   Visibility vis;
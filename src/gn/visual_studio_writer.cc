@@ -30,6 +30,7 @@
 #include "gn/variables.h"
 #include "gn/visual_studio_utils.h"
 #include "gn/xml_element_writer.h"
+#include "util/worker_pool.h"
 
 #if defined(OS_WIN)
 #include "base/win/registry.h"
@@ -360,23 +361,41 @@ bool VisualStudioWriter::RunAndWriteFiles(const BuildSettings* build_settings,
   }
 
   VisualStudioWriter writer(build_settings, config_platform, version, win_kit);
-  writer.projects_.reserve(targets.size());
-  writer.folders_.reserve(targets.size());
 
-  for (const Target* target : targets) {
-    // Skip actions and bundle targets.
-    if (target->output_type() == Target::ACTION ||
-        target->output_type() == Target::ACTION_FOREACH ||
-        target->output_type() == Target::BUNDLE_DATA ||
-        target->output_type() == Target::COPY_FILES ||
-        target->output_type() == Target::CREATE_BUNDLE ||
-        target->output_type() == Target::GENERATED_FILE) {
-      continue;
+  // Skip actions and bundle targets.
+  std::erase_if(targets, [](const Target* target) {
+    return target->output_type() == Target::ACTION ||
+           target->output_type() == Target::ACTION_FOREACH ||
+           target->output_type() == Target::BUNDLE_DATA ||
+           target->output_type() == Target::COPY_FILES ||
+           target->output_type() == Target::CREATE_BUNDLE ||
+           target->output_type() == Target::GENERATED_FILE;
+  });
+
+  // Project files only depend on their target, so they are generated and
+  // written in parallel. The first error in target order is reported.
+  SolutionProjects projects(targets.size());
+  std::vector<Err> errors(targets.size());
+  {
+    // The pool waits for all posted tasks when it goes out of scope.
+    WorkerPool pool;
+    for (size_t i = 0; i < targets.size(); i++) {
+      pool.PostTask([&writer, &targets, &projects, &errors, &ninja_extra_args,
+                     &ninja_executable, i]() {
+        projects[i] = writer.WriteProjectFiles(targets[i], ninja_extra_args,
+                                               ninja_executable, &errors[i]);
+      });
     }
+  }
 
-    if (!writer.WriteProjectFiles(target, ninja_extra_args, ninja_executable,
-                                  err))
+  writer.projects_.reserve(targets.size());
+  writer.folders_.reserve(targets.size());
+  for (size_t i = 0; i < targets.size(); i++) {
+    if (errors[i].has_error()) {
+      *err = errors[i];
       return false;
+    }
+    writer.projects_.push_back(std::move(projects[i]));
   }
 
   if (writer.projects_.empty()) {
@@ -396,10 +415,11 @@ bool VisualStudioWriter::RunAndWriteFiles(const BuildSettings* build_settings,
   return writer.WriteSolutionFile(sln_name, err);
 }
 
-bool VisualStudioWriter::WriteProjectFiles(const Target* target,
-                                           const std::string& ninja_extra_args,
-                                           const std::string& ninja_executable,
-                                           Err* err) {
+std::unique_ptr<VisualStudioWriter::SolutionProject>
+VisualStudioWriter::WriteProjectFiles(const Target* target,
+                                      const std::string& ninja_extra_args,
+                                      const std::string& ninja_executable,
+                                      Err* err) const {
   std::string project_name = target->label().name();
   const char* project_config_platform = config_platform_;
   if (!target->settings()->is_default()) {
@@ -416,39 +436,40 @@ bool VisualStudioWriter::WriteProjectFiles(const Target* target,
       GetBuildDirForTargetAsSourceDir(target, BuildDirType::OBJ)
           .ResolveRelativeFile(Value(nullptr, project_name + ".vcxproj"), err);
   if (target_file.is_null())
-    return false;
+    return nullptr;
 
   base::FilePath vcxproj_path = build_settings_->GetFullPath(target_file);
   std::string vcxproj_path_str = FilePathToUTF8(vcxproj_path);
 
-  projects_.push_back(std::make_unique<SolutionProject>(
+  auto project = std::make_unique<SolutionProject>(
       project_name, vcxproj_path_str,
       MakeGuid(vcxproj_path_str, kGuidSeedProject),
       FilePathToUTF8(build_settings_->GetFullPath(target->label().dir())),
-      project_config_platform));
+      project_config_platform);
 
   StringOutputBuffer vcxproj_storage;
   std::ostream vcxproj_string_out(&vcxproj_storage);
   SourceFileCompileTypePairs source_types;
-  if (!WriteProjectFileContents(vcxproj_string_out, *projects_.back(), target,
+  if (!WriteProjectFileContents(vcxproj_string_out, *project, target,
                                 ninja_extra_args, ninja_executable,
                                 &source_types, err)) {
-    projects_.pop_back();
-    return false;
+    return nullptr;
   }
 
   // Only write the content to the file if it's different. That is
   // both a performance optimization and more importantly, prevents
   // Visual Studio from reloading the projects.
   if (!vcxproj_storage.WriteToFileIfChanged(vcxproj_path, err))
-    return false;
+    return nullptr;
 
   base::FilePath filters_path = UTF8ToFilePath(vcxproj_path_str + ".filters");
 
   StringOutputBuffer filters_storage;
   std::ostream filters_string_out(&filters_storage);
   WriteFiltersFileContents(filters_string_out, target, source_types);
-  return filters_storage.WriteToFileIfChanged(filters_path, err);
+  if (!filters_storage.WriteToFileIfChanged(filters_path, err))
+    return nullptr;
+  return project;
 }
 
 bool VisualStudioWriter::WriteProjectFileContents(
@@ -458,7 +479,7 @@ bool VisualStudioWriter::WriteProjectFileContents(
     const std::string& ninja_extra_args,
     const std::string& ninja_executable,
     SourceFileCompileTypePairs* source_types,
-    Err* err) {
+    Err* err) const {
   PathOutput path_output(
       GetBuildDirForTargetAsSourceDir(target, BuildDirType::OBJ),
       build_settings_->root_path_utf8(), EscapingMode::ESCAPE_NONE);
@@ -687,7 +708,7 @@ bool VisualStudioWriter::WriteProjectFileContents(
 void VisualStudioWriter::WriteFiltersFileContents(
     std::ostream& out,
     const Target* target,
-    const SourceFileCompileTypePairs& source_types) {
+    const SourceFileCompileTypePairs& source_types) const {
   out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl;
   XmlElementWriter project(
       out, "Project",
@@ -928,7 +949,7 @@ void VisualStudioWriter::ResolveSolutionFolders() {
 }
 
 std::pair<std::string, bool> VisualStudioWriter::GetNinjaTarget(
-    const Target* target) {
+    const Target* target) const {
   std::ostringstream ninja_target_out;
   bool is_phony = false;
   OutputFile output_file;
@@ -109,20 +109,24 @@ class VisualStudioWriter {
                      const std::string& win_kit);
   ~VisualStudioWriter();
 
-  bool WriteProjectFiles(const Target* target,
-                         const std::string& ninja_extra_args,
-                         const std::string& ninja_executable,
-                         Err* err);
+  // Writes the project and filters files of |target|. Returns the solution
+  // project for it, or null on error. This is called from multiple threads.
+  std::unique_ptr<SolutionProject> WriteProjectFiles(
+      const Target* target,
+      const std::string& ninja_extra_args,
+      const std::string& ninja_executable,
+      Err* err) const;
   bool WriteProjectFileContents(std::ostream& out,
                                 const SolutionProject& solution_project,
                                 const Target* target,
                                 const std::string& ninja_extra_args,
                                 const std::string& ninja_executable,
                                 SourceFileCompileTypePairs* source_types,
-                                Err* err);
-  void WriteFiltersFileContents(std::ostream& out,
-                                const Target* target,
-                                const SourceFileCompileTypePairs& source_types);
+                                Err* err) const;
+  void WriteFiltersFileContents(
+      std::ostream& out,
+      const Target* target,
+      const SourceFileCompileTypePairs& source_types) const;
   bool WriteSolutionFile(const std::string& sln_name, Err* err);
   void WriteSolutionFileContents(std::ostream& out,
                                  const base::FilePath& solution_dir_path);
@@ -132,7 +136,7 @@ class VisualStudioWriter {
   void ResolveSolutionFolders();
 
   // Returns the ninja target string and whether the target is phony.
-  std::pair<std::string, bool> GetNinjaTarget(const Target* target);
+  std::pair<std::string, bool> GetNinjaTarget(const Target* target) const;
 
   const BuildSettings* build_settings_;
 
@@ -51,43 +51,47 @@ std::string EncodeString(const std::string& string) {
   if (!StringNeedEscaping(string))
     return string;
 
-  std::stringstream buffer;
-  buffer << '"';
+  std::string buffer;
+  buffer.reserve(string.size() + 2);
+  buffer.push_back('"');
   for (char c : string) {
     if (c <= 31) {
       switch (c) {
         case '\a':
-          buffer << "\\a";
+          buffer.append("\\a");
           break;
         case '\b':
-          buffer << "\\b";
+          buffer.append("\\b");
           break;
         case '\t':
-          buffer << "\\t";
+          buffer.append("\\t");
           break;
         case '\n':
         case '\r':
-          buffer << "\\n";
+          buffer.append("\\n");
           break;
         case '\v':
-          buffer << "\\v";
+          buffer.append("\\v");
           break;
         case '\f':
-          buffer << "\\f";
+          buffer.append("\\f");
           break;
-        default:
-          buffer << std::hex << std::setw(4) << std::left << "\\U"
+        default: {
+          std::stringstream escape;
+          escape << std::hex << std::setw(4) << std::left << "\\U"
                  << static_cast<unsigned>(c);
+          buffer.append(escape.str());
           break;
+        }
       }
     } else {
       if (c == '"' || c == '\\')
-        buffer << '\\';
-      buffer << c;
+        buffer.push_back('\\');
+      buffer.push_back(c);
     }
   }
-  buffer << '"';
-  return buffer.str();
+  buffer.push_back('"');
+  return buffer;
 }
 
 struct SourceTypeForExt {
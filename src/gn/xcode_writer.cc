@@ -4,6 +4,7 @@
 
 #include "gn/xcode_writer.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <iterator>
 #include <map>
@@ -40,6 +41,7 @@
 #include "gn/value.h"
 #include "gn/variables.h"
 #include "gn/xcode_object.h"
+#include "util/worker_pool.h"
 
 namespace {
 
@@ -341,39 +343,60 @@ CollectPBXObjectsPerClass(const PBXProject* project) {
   return visitor.objects_per_class();
 }
 
-// Helper class to assign unique ids to all PBXObject.
-class RecursivelyAssignIdsHelper : public PBXObjectVisitor {
+// Helper class to collect all PBXObject in visit order.
+class CollectPBXObjectsHelper : public PBXObjectVisitor {
  public:
-  RecursivelyAssignIdsHelper(const std::string& seed)
-      : seed_(seed), counter_(0) {}
+  CollectPBXObjectsHelper() = default;
 
   void Visit(PBXObject* object) override {
-    std::stringstream buffer;
-    buffer << seed_ << " " << object->Name() << " " << counter_;
-    std::string hash = base::SHA1HashString(buffer.str());
-    DCHECK_EQ(hash.size() % 4, 0u);
-
-    uint32_t id[3] = {0, 0, 0};
-    const uint32_t* ptr = reinterpret_cast<const uint32_t*>(hash.data());
-    for (size_t i = 0; i < hash.size() / 4; i++)
-      id[i % 3] ^= ptr[i];
-
-    object->SetId(base::HexEncode(id, sizeof(id)));
-    ++counter_;
+    DCHECK(object);
+    objects_.push_back(object);
   }
 
+  const std::vector<PBXObject*>& objects() const { return objects_; }
+
  private:
-  std::string seed_;
-  int64_t counter_;
+  std::vector<PBXObject*> objects_;
 
-  RecursivelyAssignIdsHelper(const RecursivelyAssignIdsHelper&) = delete;
-  RecursivelyAssignIdsHelper& operator=(const RecursivelyAssignIdsHelper&) =
-      delete;
+  CollectPBXObjectsHelper(const CollectPBXObjectsHelper&) = delete;
+  CollectPBXObjectsHelper& operator=(const CollectPBXObjectsHelper&) = delete;
 };
 
+// Returns the id of the |index|-th object in visit order.
+std::string ComputeObjectId(const std::string& seed,
+                            const PBXObject* object,
+                            size_t index) {
+  std::string hash = base::SHA1HashString(seed + " " + object->Name() + " " +
+                                          base::NumberToString(index));
+  DCHECK_EQ(hash.size() % 4, 0u);
+
+  uint32_t id[3] = {0, 0, 0};
+  const uint32_t* ptr = reinterpret_cast<const uint32_t*>(hash.data());
+  for (size_t i = 0; i < hash.size() / 4; i++)
+    id[i % 3] ^= ptr[i];
+
+  return base::HexEncode(id, sizeof(id));
+}
+
+// Assigns unique ids to all PBXObject. The id of an object only depends on
+// its position in visit order, so they are computed in parallel.
 void RecursivelyAssignIds(PBXProject* project) {
-  RecursivelyAssignIdsHelper visitor(project->Name());
+  CollectPBXObjectsHelper visitor;
   project->Visit(visitor);
+
+  const std::string seed = project->Name();
+  const std::vector<PBXObject*>& objects = visitor.objects();
+  constexpr size_t kObjectsPerChunk = 1024;
+
+  // The pool waits for all posted tasks when it goes out of scope.
+  WorkerPool pool;
+  for (size_t begin = 0; begin < objects.size(); begin += kObjectsPerChunk) {
+    size_t end = std::min(objects.size(), begin + kObjectsPerChunk);
+    pool.PostTask([&seed, &objects, begin, end]() {
+      for (size_t i = begin; i < end; i++)
+        objects[i]->SetId(ComputeObjectId(seed, objects[i], i));
+    });
+  }
 }
 
 // Returns a list of configuration names from the options passed to the
@@ -659,8 +682,8 @@ class XcodeProject {
   // directory (see --xcode-config-build-dir=... flag).
   std::string GetConfigOutputDir(std::string_view output_dir);
 
-  // Generates the content of the .xcodeproj file into |out|.
-  void WriteFileContent(std::ostream& out) const;
+  // Generates the content of the .xcodeproj file into |storage|.
+  void WriteFileContent(StringOutputBuffer& storage) const;
 
   // Returns whether the file should be added to the project.
   bool ShouldIncludeFileInProject(const SourceFile& source) const;
@@ -917,8 +940,7 @@ bool XcodeProject::WriteFile(Err* err) const {
     return false;
 
   StringOutputBuffer storage;
-  std::ostream pbxproj_string_out(&storage);
-  WriteFileContent(pbxproj_string_out);
+  WriteFileContent(storage);
 
   if (!storage.WriteToFileIfChanged(build_settings_->GetFullPath(pbxproj_file),
                                     err)) {
@@ -1062,7 +1084,8 @@ std::string XcodeProject::GetConfigOutputDir(std::string_view output_dir) {
                     build_settings_->root_path_utf8());
 }
 
-void XcodeProject::WriteFileContent(std::ostream& out) const {
+void XcodeProject::WriteFileContent(StringOutputBuffer& storage) const {
+  std::ostream out(&storage);
   out << "// !$*UTF8*$!\n"
       << "{\n"
       << "\tarchiveVersion = 1;\n"
@@ -1071,14 +1094,54 @@ void XcodeProject::WriteFileContent(std::ostream& out) const {
       << "\tobjectVersion = 46;\n"
       << "\tobjects = {\n";
 
-  for (auto& pair : CollectPBXObjectsPerClass(&project_)) {
-    out << "\n" << "/* Begin " << ToString(pair.first) << " section */\n";
+  std::map<PBXObjectClass, std::vector<const PBXObject*>> objects_per_class =
+      CollectPBXObjectsPerClass(&project_);
+  for (auto& pair : objects_per_class) {
     std::sort(pair.second.begin(), pair.second.end(),
               [](const PBXObject* a, const PBXObject* b) {
                 return a->id() < b->id();
               });
-    for (auto* object : pair.second) {
-      object->Print(out, 2);
+  }
+
+  // Objects are printed in parallel by chunks, each into its own buffer,
+  // then the chunks are assembled in order.
+  constexpr size_t kObjectsPerChunk = 256;
+  struct Chunk {
+    const std::vector<const PBXObject*>* objects;
+    size_t begin;
+    size_t end;
+    StringOutputBuffer output;
+  };
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (const auto& pair : objects_per_class) {
+    for (size_t begin = 0; begin < pair.second.size();
+         begin += kObjectsPerChunk) {
+      auto chunk = std::make_unique<Chunk>();
+      chunk->objects = &pair.second;
+      chunk->begin = begin;
+      chunk->end = std::min(pair.second.size(), begin + kObjectsPerChunk);
+      chunks.push_back(std::move(chunk));
+    }
+  }
+  {
+    // The pool waits for all posted tasks when it goes out of scope.
+    WorkerPool pool;
+    for (const auto& chunk : chunks) {
+      pool.PostTask([chunk = chunk.get()]() {
+        std::ostream chunk_out(&chunk->output);
+        for (size_t i = chunk->begin; i < chunk->end; i++)
+          (*chunk->objects)[i]->Print(chunk_out, 2);
+      });
+    }
+  }
+
+  auto next_chunk = chunks.begin();
+  for (const auto& pair : objects_per_class) {
+    out << "\n" << "/* Begin " << ToString(pair.first) << " section */\n";
+    while (next_chunk != chunks.end() &&
+           (*next_chunk)->objects == &pair.second) {
+      storage.Append((*next_chunk)->output);
+      ++next_chunk;
     }
     out << "/* End " << ToString(pair.first) << " section */\n";
   }